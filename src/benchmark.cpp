@@ -0,0 +1,87 @@
+/*
+ * 並列演算のスケーリングを測定します
+ *
+ * N-Queens の制約を表す論理関数を 1 スレッドから最大のスレッド数まで構築し、
+ * それぞれの所要時間と 1 スレッドに対する速度向上率を表示します。
+ *
+ * usage: benchmark [N] [最大のスレッド数]
+ *
+ * CMAKE_BUILD_TYPE=Release でビルドしたものを用いてください。
+ */
+#include <boloq.h>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+using namespace std;
+using namespace boloq;
+
+namespace {
+
+using function_type = parallel_boolean_function;
+
+/*!
+ * N-Queens の解を表す論理関数を構築します
+ *
+ * 測定ごとに演算キャッシュの結果を再利用しないよう、変数のラベルを base からずらします。
+ */
+function_type queens(const uint32_t n, const uint32_t base) {
+    auto var = [n, base](const uint32_t r, const uint32_t c) {
+        return function_type(base + r * n + c);
+    };
+    auto f = function_type::one();
+    for (uint32_t r = 0; r < n; r++) {
+        auto row = function_type::zero();
+        for (uint32_t c = 0; c < n; c++) row |= var(r, c);
+        f &= row;
+    }
+    for (uint32_t r = 0; r < n; r++) {
+        for (uint32_t c = 0; c < n; c++) {
+            auto others = function_type::one();
+            for (uint32_t r2 = 0; r2 < n; r2++) {
+                for (uint32_t c2 = 0; c2 < n; c2++) {
+                    if (r2 == r && c2 == c) continue;
+                    const bool attacked = r2 == r || c2 == c ||
+                        r2 + c == r + c2 || r2 + c2 == r + c;
+                    if (attacked) others &= ~var(r2, c2);
+                }
+            }
+            f &= ~var(r, c) | others;
+        }
+    }
+    return f;
+}
+
+}
+
+int main(int argc, char** argv) {
+    const uint32_t n = (argc > 1) ? atoi(argv[1]) : 9;
+    const size_t hw = max<size_t>(thread::hardware_concurrency(), 1);
+    const size_t max_threads = (argc > 2) ? atoi(argv[2]) : hw;
+
+    auto& table = function_type::table();
+    table.reserve(25);
+    table.set_cache_size(20);
+
+    cout << "queens " << n << endl;
+    cout << "threads\tseconds\tspeedup\tnodes" << endl;
+    vector<size_t> counts;
+    for (size_t t = 1; t < max_threads; t *= 2) counts.push_back(t);
+    counts.push_back(max_threads);
+
+    double base_time = 0;
+    uint32_t base_label = 0;
+    for (const size_t t : counts) {
+        table.set_threads(t);
+        const auto start = chrono::steady_clock::now();
+        const auto f = queens(n, base_label);
+        const double sec = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        if (t == 1) base_time = sec;
+        cout << t << '\t' << fixed << setprecision(3) << sec << '\t'
+             << setprecision(2) << base_time / sec << '\t' << table.size() << endl;
+        base_label += n * n;
+    }
+    return 0;
+}
@@ -27,6 +27,8 @@
  * ~~~~~~~~~~~~~~~
  *
  * 表示に用いる boloq/io.h を別途 include しなければならないことに注意してください。
+ * operator<< は木として表示するため、大きな図には boloq/io.h の
+ * write_dot/write_json/write_edge_list を用いてください。共有されたノードを一度だけ書き出します。
  *
  * ## コンパイル
  *
@@ -38,6 +40,63 @@
  * * boolean_function: BDDを用いて表します。
  * * combination: ZDDを用いて表します。
  *
+ * # ノードの格納方式
+ *
+ * * node: ノードを個別に確保し std::shared_ptr で管理します。
+ * * arena_node: ノードをページ単位で連続して確保し、32bit のハンドルで参照します。
+ *   arena_boolean_function/arena_combination から利用できます。
+ * * complement_arena_node: arena_node に否定枝を加えたものです。
+ *   complement_boolean_function から利用でき、否定を O(1) で求めます。
+ * * arena_node と complement_arena_node を用いる論理関数は、変数の順序を変更できます。
+ *   table().reorder() で sifting を行い、table().set_auto_reorder(true) で自動的に行います。
+ * * concurrent_arena_node: 複数のスレッドから同時にノードを生成できるアリーナです。
+ *   parallel_boolean_function/parallel_combination から利用できます。
+ *   table().set_threads(n) を呼び出すと演算を n スレッドで並列に行います。
+ *   この場合はスレッドライブラリ (-pthread) のリンクが必要です。
+ *
+ * # 変数の順序
+ *
+ * boloq/ordering.h は問題の構造から初期の変数の順序を求めます。
+ * 節やゲートに含まれる変数の集合を与えると force_order や min_span_order が、
+ * 論理回路を与えると dfs_order が、変数に割り当てるラベルを返します。
+ *
+ * # CNF の読み込み
+ *
+ * boloq/dimacs.h の read_dimacs で DIMACS 形式の CNF を読み込み、
+ * cnf_builder で論理関数に変換します。節の論理積を取る順序は conjoin_schedule で選べ、
+ * bucket では量化する変数をそのバケットで早めに量化します。
+ * 節の一覧が要らなければ、dimacs_reader を build に渡すと節を読みながら変換します。
+ *
+ * # 回路の読み込み
+ *
+ * boloq/netlist.h の read_aiger/read_blif で組み合わせ回路を読み込み、
+ * netlist_builder で外部出力の論理関数を生成します。
+ * dfs_order で求めた変数の順序を set_labels で与えられます。
+ *
+ * # 保存と読み込み
+ *
+ * boloq/serialize.h の save_diagrams/load_diagrams で、図を二進形式で保存して読み込めます。
+ * 複数の図が共有するノードは一度だけ保存され、読み込みはノードの数に比例する時間で行えます。
+ *
+ * boloq/mapped.h の save_mapped で書き出したファイルは、mapped_file で写像して
+ * mapped_boolean_function/mapped_combination から複製せずに参照できます。
+ * 同じファイルを写像した複数のプロセスはページを共有します。
+ *
+ * # マネージャ
+ *
+ * boolean_function('x') のように生成したものは、型ごとに1つの既定のテーブルを共有します。
+ * boolean_function_manager などのマネージャを用いると、独立したテーブルを持つことができます。
+ *
+ * ~~~~~~~~~~~~~~~{.cpp}
+ * arena_boolean_function_manager m;
+ * auto x = m.var('x');
+ * auto y = m.var('y');
+ * auto f = x & ~y;
+ * ~~~~~~~~~~~~~~~
+ *
+ * マネージャを破棄するとノードはまとめて解放されるため、
+ * マネージャより長く生存する論理関数を残してはいけません。
+ *
  * # このライブラリのメリット
  *
  * * 標準ライブラリを用いており、比較的シンプルです
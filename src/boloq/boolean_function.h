@@ -15,4 +15,59 @@ using boolean_function_cache = basic_boolean_function_cache<node>;
  */
 using boolean_function = basic_boolean_function<boolean_function_cache>;
 
+/*!
+ * @brief アリーナに格納されるノードを用いるハッシュテーブル
+ */
+using arena_boolean_function_cache = basic_boolean_function_cache<arena_node>;
+
+/*!
+ * @brief アリーナに格納されるノードを用いる論理関数
+ */
+using arena_boolean_function = basic_boolean_function<arena_boolean_function_cache>;
+
+/*!
+ * @brief 否定枝を用いるハッシュテーブル
+ */
+using complement_boolean_function_cache = basic_boolean_function_cache<complement_arena_node>;
+
+/*!
+ * @brief 否定枝を用いる論理関数
+ *
+ * 否定を O(1) で求めることができます。
+ */
+using complement_boolean_function = basic_boolean_function<complement_boolean_function_cache>;
+
+/*!
+ * @brief 並列に演算を行えるハッシュテーブル
+ */
+using parallel_boolean_function_cache = basic_boolean_function_cache<concurrent_arena_node>;
+
+/*!
+ * @brief 並列に演算を行える論理関数
+ *
+ * table().set_threads() でスレッドの数を設定します。
+ * ノードは回収されません。
+ */
+using parallel_boolean_function = basic_boolean_function<parallel_boolean_function_cache>;
+
+/*!
+ * @brief 標準的なノードを用いる論理関数のマネージャ
+ */
+using boolean_function_manager = basic_manager<boolean_function>;
+
+/*!
+ * @brief アリーナに格納されるノードを用いる論理関数のマネージャ
+ */
+using arena_boolean_function_manager = basic_manager<arena_boolean_function>;
+
+/*!
+ * @brief 否定枝を用いる論理関数のマネージャ
+ */
+using complement_boolean_function_manager = basic_manager<complement_boolean_function>;
+
+/*!
+ * @brief 並列に演算を行える論理関数のマネージャ
+ */
+using parallel_boolean_function_manager = basic_manager<parallel_boolean_function>;
+
 }
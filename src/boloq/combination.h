@@ -3,7 +3,6 @@
 #include <boloq/common.h>
 #include <boloq/details/combination_cache.h>
 #include <boloq/details/combination.h>
-#include <boloq/details/visitors/count.h>
 
 namespace boloq {
 
@@ -17,4 +16,42 @@ using combination_cache = basic_combination_cache<node>;
  */
 using combination = basic_combination<combination_cache>;
 
+/*!
+ * @brief アリーナに格納されるノードを用いるハッシュテーブルです
+ */
+using arena_combination_cache = basic_combination_cache<arena_node>;
+
+/*!
+ * @brief アリーナに格納されるノードを用いる組み合わせ集合です
+ */
+using arena_combination = basic_combination<arena_combination_cache>;
+
+/*!
+ * @brief 並列に演算を行えるハッシュテーブルです
+ */
+using parallel_combination_cache = basic_combination_cache<concurrent_arena_node>;
+
+/*!
+ * @brief 並列に演算を行える組み合わせ集合です
+ *
+ * table().set_threads() でスレッドの数を設定します。
+ * ノードは回収されません。
+ */
+using parallel_combination = basic_combination<parallel_combination_cache>;
+
+/*!
+ * @brief 標準的なノードを用いる組み合わせ集合のマネージャです
+ */
+using combination_manager = basic_manager<combination>;
+
+/*!
+ * @brief アリーナに格納されるノードを用いる組み合わせ集合のマネージャです
+ */
+using arena_combination_manager = basic_manager<arena_combination>;
+
+/*!
+ * @brief 並列に演算を行える組み合わせ集合のマネージャです
+ */
+using parallel_combination_manager = basic_manager<parallel_combination>;
+
 }
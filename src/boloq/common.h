@@ -1,13 +1,43 @@
 #pragma once
+#include <algorithm>
+#include <atomic>
+#include <bitset>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <limits>
 #include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
 #include <tuple>
 #include <unordered_map>
+#include <vector>
 #include <boost/functional/hash.hpp>
-#include <boloq/details/index_generator.h>
+#include <boloq/details/unique_table.h>
+#include <boloq/details/operation_cache.h>
+#include <boloq/details/concurrent_operation_cache.h>
+#include <boloq/details/work_stealing_pool.h>
+#include <boloq/details/apply_stack.h>
 #include <boloq/details/node.h>
+#include <boloq/details/node_store.h>
+#include <boloq/details/arena_node.h>
+#include <boloq/details/concurrent_arena_node.h>
+#include <boloq/details/reorder.h>
 #include <boloq/details/tuple_hash.h>
 #include <boloq/details/visitors/execute.h>
 #include <boloq/details/visitors/function_types.h>
+#include <boloq/details/visitors/count.h>
+#include <boloq/details/batch_evaluator.h>
+#include <boloq/details/compiled_function.h>
+#include <boloq/details/path_iterator.h>
+#include <boloq/details/manager.h>
 
 namespace boloq {
 
@@ -16,4 +46,19 @@ namespace boloq {
  */
 using node = basic_node<size_t, size_t>;
 
+/*!
+ * @brief アリーナに格納される 16 バイトのノードのクラス
+ */
+using arena_node = basic_arena_node<uint32_t, uint32_t>;
+
+/*!
+ * @brief 否定枝を用いる、アリーナに格納されるノードのクラス
+ */
+using complement_arena_node = basic_arena_node<uint32_t, uint32_t, true>;
+
+/*!
+ * @brief 複数のスレッドから同時に生成できる、アリーナに格納されるノードのクラス
+ */
+using concurrent_arena_node = basic_concurrent_arena_node<uint32_t, uint32_t>;
+
 }
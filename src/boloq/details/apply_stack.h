@@ -0,0 +1,133 @@
+#pragma once
+
+namespace boloq {
+
+/*!
+ * @brief 明示的なスタックを用いて演算を適用するエンジンです
+ *
+ * 演算の呼び出しをヒープ上のスタックに積んで処理するため、
+ * C++ の呼び出しの深さは変数の数に依存しません。
+ * 各フレームは演算の引数と子の数だけを保持します。
+ *
+ * 演算は次の関数を持つ必要があります。
+ *
+ * - bool resolve(operands_type& x, node_ptr& r) :
+ *   終端の規則や演算キャッシュで結果が求まれば r に設定して true を返します。
+ *   引数を標準形に書き換えても構いません
+ * - size_t expand(operands_type& x, operands_type* sub) :
+ *   子の演算の引数を sub に設定し、その数を返します。
+ *   x に書き込んだ値は combine に渡されます
+ * - node_ptr combine(const operands_type& x, const node_ptr* r) :
+ *   子の演算の結果から結果を求めます
+ *
+ * resolve, expand, combine のいずれの中から別の演算を呼び出しても構いません。
+ * 同じエンジンを使う入れ子の呼び出しはスタックの続きにフレームを積み、
+ * 戻るまでに全て取り除くため、呼び出し元のフレームは元のまま残ります。
+ * ZDD の除算などは、子の引数を求めるために expand の中で和集合を計算します。
+ *
+ * @tparam Operands 演算の引数の型
+ * @tparam NodePtr 演算の結果の型
+ * @tparam MaxChildren 1回の展開で生成される子の数の上限
+ */
+template<class Operands, class NodePtr, size_t MaxChildren = 2>
+class apply_stack {
+public:
+    /*! @brief 演算の引数の型 */
+    using operands_type = Operands;
+    /*! @brief 演算の結果の型 */
+    using node_ptr = NodePtr;
+    /*! @brief 1回の展開で生成される子の数の上限 */
+    static constexpr size_t max_children = MaxChildren;
+
+private:
+    struct frame {
+        operands_type operands;
+        unsigned char children;
+        bool expanded;
+    };
+
+    std::vector<frame> frames;
+    std::vector<node_ptr> results;
+    size_t _max_depth;
+
+public:
+
+    apply_stack() : _max_depth(0) {}
+
+    /*!
+     * @brief 演算を適用した結果を返します
+     */
+    template<class Op>
+    const node_ptr run(Op op, const operands_type& x) {
+        const size_t base = frames.size();
+        frames.push_back(frame{x, 0, false});
+        while (frames.size() > base) {
+            _max_depth = std::max(_max_depth, frames.size());
+            // resolve, expand, combine が同じエンジンを使うと frames が再配置されるため、
+            // フレームへの参照は保持しない
+            if (!frames.back().expanded) {
+                operands_type operands = frames.back().operands;
+                node_ptr r;
+                if (op.resolve(operands, r)) {
+                    frames.pop_back();
+                    results.push_back(r);
+                    continue;
+                }
+                operands_type sub[MaxChildren];
+                const size_t n = op.expand(operands, sub);
+                frames.back().operands = operands;
+                frames.back().children = static_cast<unsigned char>(n);
+                frames.back().expanded = true;
+                // 逆順に積むと先頭の子から計算される
+                for (size_t i = n; i-- > 0;) frames.push_back(frame{sub[i], 0, false});
+            }
+            else {
+                const operands_type operands = frames.back().operands;
+                const size_t n = frames.back().children;
+                frames.pop_back();
+                node_ptr sub[MaxChildren];
+                std::copy(results.end() - n, results.end(), sub);
+                results.erase(results.end() - n, results.end());
+                results.push_back(op.combine(operands, sub));
+            }
+        }
+        const node_ptr r = results.back();
+        results.pop_back();
+        return r;
+    }
+
+    /*!
+     * @brief これまでに積まれたフレームの数の最大値を返します
+     */
+    size_t max_depth() const {return _max_depth;}
+};
+
+template<class Operands, class NodePtr, size_t MaxChildren>
+constexpr size_t apply_stack<Operands, NodePtr, MaxChildren>::max_children;
+
+/*!
+ * @brief 演算の上位の階層を並列に適用します
+ *
+ * depth 段目までは子の演算をスレッドプールで並列に実行し、
+ * それより下は local() が返すスレッドごとのエンジンで逐次に実行します。
+ * 演算は複数のスレッドから同時に呼び出されても良いものでなければなりません。
+ */
+template<class Stack, class Op>
+typename Stack::node_ptr parallel_apply(work_stealing_pool& pool, Stack& (*local)(), Op op,
+                                        typename Stack::operands_type x, const size_t depth) {
+    using node_ptr = typename Stack::node_ptr;
+    using operands_type = typename Stack::operands_type;
+    if (depth == 0) return local().run(op, x);
+
+    node_ptr r;
+    if (op.resolve(x, r)) return r;
+    operands_type sub[Stack::max_children];
+    const size_t n = op.expand(x, sub);
+    node_ptr results[Stack::max_children];
+    pool.invoke(n, [&](const size_t i) {
+        results[i] = parallel_apply(pool, local, op, sub[i], depth - 1);
+    });
+    return op.combine(x, results);
+}
+
+}
@@ -0,0 +1,689 @@
+#pragma once
+
+namespace boloq {
+
+template<class N>
+class arena_node_store;
+
+template<class N>
+class arena_node_ptr;
+
+template<class N>
+class arena_root_ptr;
+
+/*!
+ * @brief アリーナに連続して格納されるノードのクラス
+ *
+ * 子ノードはポインタではなく整数のハンドルで参照します。
+ * index_type に 32bit 整数を用いると 1 ノードあたり 16 バイトに収まります。
+ *
+ * C が true の場合は否定枝を用います。
+ * ハンドルの最下位ビットが 0 であれば、そのハンドルは参照先のノードの否定を表します。
+ */
+template<class LT, class IT, bool C = false>
+struct basic_arena_node {
+    /*! @brief インデックスを表す型 */
+    using index_type = IT;
+    /*! @brief ラベルを表す型 */
+    using label_type = LT;
+    /*! このクラスを格納するテーブルの型 */
+    using store_type = arena_node_store<basic_arena_node<LT, IT, C>>;
+    /*! このクラスのハンドルを表す型 */
+    using node_ptr = arena_node_ptr<basic_arena_node<LT, IT, C>>;
+    /*! 論理関数や組み合わせ集合が保持するハンドルを表す型 */
+    using root_ptr = arena_root_ptr<basic_arena_node<LT, IT, C>>;
+
+    /*! @brief 否定枝を用いるかどうか */
+    static constexpr bool complement_edges = C;
+
+    /*! @brief ノードのラベル */
+    label_type label;
+    /*! @brief 1枝側のノードのハンドル */
+    index_type then_id;
+    /*! @brief 0枝側のノードのハンドル */
+    index_type else_id;
+    /*! @brief 親ノードと root_ptr からの参照の数 */
+    index_type refs;
+};
+
+/*!
+ * @brief アリーナ上のノードを指すハンドルです
+ *
+ * 参照カウントを操作しないため、コピーは整数のコピーと同じ程度の費用で行えます。
+ * basic_node::node_ptr と同じように -> でノードの内容を参照できます。
+ */
+template<class N>
+class arena_node_ptr {
+private:
+    using self_type = arena_node_ptr<N>;
+
+public:
+    /*! @brief ノードを格納するテーブルの型 */
+    using store_type = typename N::store_type;
+    /*! @brief インデックスを表す型 */
+    using index_type = typename N::index_type;
+    /*! @brief ラベルを表す型 */
+    using label_type = typename N::label_type;
+
+private:
+    const store_type* _store;
+    index_type _index;
+
+public:
+
+    constexpr arena_node_ptr() : _store(nullptr), _index(0) {}
+    constexpr arena_node_ptr(std::nullptr_t) : _store(nullptr), _index(0) {}
+
+    /*!
+     * @brief コンストラクタ
+     *
+     * @param s ノードを格納しているテーブル
+     * @param i ノードのハンドル
+     */
+    constexpr arena_node_ptr(const store_type* s, const index_type& i) :
+            _store(s), _index(i)
+    {}
+
+    /*!
+     * @brief ノードの内容を参照します
+     */
+    const self_type* operator->() const {return this;}
+
+    /*!
+     * @brief ノードの内容一意に定まる値を返します
+     */
+    constexpr const index_type& index() const {return _index;}
+
+    /*!
+     * @brief ノードのラベルを返します
+     */
+    const label_type& label() const {return _store->label(_index);}
+
+    /*!
+     * @brief このノードが終端かどうかを表します
+     */
+    constexpr bool is_terminal() const {return _index < 2;}
+
+    /*! 1枝側のノードを返します */
+    const self_type then_node() const {
+        return self_type(_store, _store->then_index(_index));
+    }
+    /*! 0枝側のノードを返します */
+    const self_type else_node() const {
+        return self_type(_store, _store->else_index(_index));
+    }
+
+    /*!
+     * @brief ノードを格納しているテーブルを返します
+     */
+    constexpr const store_type* store() const {return _store;}
+
+    /*!
+     * @brief visitorを受理します
+     */
+    template<class V>
+    typename V::result_type accept(V& visitor) const {
+        return visitor(*this);
+    }
+    template<class V>
+    typename V::result_type accept(const V& visitor) const {
+        return visitor(*this);
+    }
+
+    constexpr bool operator==(const self_type& o) const {
+        return _index == o._index && _store == o._store;
+    }
+    constexpr bool operator!=(const self_type& o) const {
+        return !(*this == o);
+    }
+    constexpr bool operator==(std::nullptr_t) const {return _store == nullptr;}
+    constexpr bool operator!=(std::nullptr_t) const {return _store != nullptr;}
+};
+
+/*!
+ * @brief 参照カウントを保持するハンドルです
+ *
+ * basic_boolean_function や basic_combination が保持し、
+ * 生存している間は参照先のノードの参照カウントを 1 増やします。
+ */
+template<class N>
+class arena_root_ptr {
+private:
+    using self_type = arena_root_ptr<N>;
+    using node_ptr = arena_node_ptr<N>;
+
+    node_ptr _ptr;
+
+    void acquire() const {
+        if (_ptr != nullptr) _ptr.store()->acquire(_ptr.index());
+    }
+
+    void release() const {
+        if (_ptr != nullptr) _ptr.store()->release(_ptr.index());
+    }
+
+public:
+
+    arena_root_ptr() : _ptr() {}
+    arena_root_ptr(std::nullptr_t) : _ptr() {}
+
+    /*!
+     * @brief ハンドルの参照カウントを増やして保持します
+     */
+    arena_root_ptr(const node_ptr& p) : _ptr(p) {
+        acquire();
+    }
+
+    arena_root_ptr(const self_type& o) : _ptr(o._ptr) {
+        acquire();
+    }
+
+    arena_root_ptr(self_type&& o) : _ptr(o._ptr) {
+        o._ptr = nullptr;
+    }
+
+    ~arena_root_ptr() {
+        release();
+    }
+
+    self_type& operator=(const self_type& o) {
+        o.acquire();
+        release();
+        _ptr = o._ptr;
+        return *this;
+    }
+
+    self_type& operator=(self_type&& o) {
+        if (this != &o) {
+            release();
+            _ptr = o._ptr;
+            o._ptr = nullptr;
+        }
+        return *this;
+    }
+
+    /*! @brief 保持しているハンドルを返します */
+    const node_ptr& get() const {return _ptr;}
+    operator const node_ptr&() const {return _ptr;}
+    const node_ptr* operator->() const {return &_ptr;}
+};
+
+/*!
+ * @brief アリーナにノードを格納するテーブルです
+ *
+ * ノードは固定長のページに連続して確保され、整数のハンドルで参照されます。
+ * ハンドル 0, 1 はそれぞれ 0-節点 と 1-節点 を表します。
+ *
+ * 否定枝を用いる場合、ハンドルはノードの番号を 1 ビット左にずらし、
+ * 否定でなければ最下位ビットを立てた値になります。
+ * 1枝は常に否定でないハンドルとなるように正規化されます。
+ *
+ * 参照カウントが 0 のノードは gc() を呼び出すまで回収されません。
+ * 回収されたノードのラベルは定節点と同じ値になります。
+ *
+ * 変数の順序は、ノードを持つ変数のラベルの値を変数の間で入れ替えた置換で表します。
+ * 順序を変更するまでは level(l) は l であり、ノードを持たない変数のラベルは順序の上でもそのままの位置にあります。
+ * ノードを持つ変数は先頭から順に位置を持ち、swap_levels() で隣接する2つを入れ替えます。
+ * 入れ替えはノードをその場で書き換えるため、ハンドルが表す関数は変わりません。
+ */
+template<class N>
+class arena_node_store {
+public:
+    /*! @brief このクラスが扱うノードの型 */
+    using node_type = N;
+    /*! @brief このクラスが扱うノードのハンドル型 */
+    using node_ptr = typename node_type::node_ptr;
+    /*! @brief 演算キャッシュに格納される型 */
+    using cache_ptr = typename node_type::index_type;
+
+    /*! @brief 否定枝を用いるかどうか */
+    static constexpr bool complement_edges = node_type::complement_edges;
+    /*! @brief 複数のスレッドから同時に操作できるかどうか */
+    static constexpr bool concurrent = false;
+    /*! @brief 変数の順序を変更できるかどうか */
+    static constexpr bool reorderable = true;
+
+private:
+    using index_type = typename node_type::index_type;
+    using label_type = typename node_type::label_type;
+
+    using unique_table_type = level_unique_table<label_type, index_type, index_type>;
+
+    static constexpr unsigned int page_bits = 16;
+    static constexpr index_type page_mask = (index_type(1) << page_bits) - 1;
+
+    /*! 定節点でない最初のノードの番号 */
+    static constexpr index_type first_id = complement_edges ? 1 : 2;
+
+    std::vector<std::unique_ptr<node_type[]>> pages;
+    index_type _size;
+    std::vector<index_type> free_ids;
+    mutable size_t _dead;
+
+    unique_table_type unique_table;
+
+    /*! unique table の変数の添字ごとの level の値 */
+    std::vector<label_type> level_of;
+    /*! 位置ごとの変数のラベルと level の値。level の値は昇順に並びます */
+    std::vector<label_type> label_of, level_values;
+    /*! 変数を入れ替えたことがあるかどうか */
+    bool permuted;
+
+    const node_ptr terminal_false, terminal_true;
+
+    /*!
+     * ハンドルからノードの番号を求めます
+     */
+    static constexpr index_type id_of(const index_type& h) {
+        return complement_edges ? h >> 1 : h;
+    }
+
+    /*!
+     * ノードの番号からハンドルを求めます
+     */
+    static constexpr index_type handle_of(const index_type& i, const bool negated) {
+        return complement_edges ? ((i << 1) | (negated ? 0 : 1)) : i;
+    }
+
+    /*!
+     * ハンドルが否定枝であれば子のハンドルを反転させるための値を返します
+     */
+    static constexpr index_type flip_of(const index_type& h) {
+        return complement_edges ? (~h & 1) : 0;
+    }
+
+    /*!
+     * 番号からノードを参照します
+     *
+     * 参照カウントはノードの内容に含まれないため、const なテーブルからも変更できます。
+     */
+    node_type& at(const index_type& i) const {
+        return pages[i >> page_bits][i & page_mask];
+    }
+
+    /*!
+     * 新しいノードの領域を確保します
+     */
+    index_type allocate() {
+        if (!free_ids.empty()) {
+            const index_type i = free_ids.back();
+            free_ids.pop_back();
+            return i;
+        }
+        if (_size == id_of(std::numeric_limits<index_type>::max())) {
+            throw std::length_error("boloq: arena_node_store is full");
+        }
+        if ((_size & page_mask) == 0) {
+            pages.emplace_back(new node_type[page_mask + 1]);
+        }
+        return _size++;
+    }
+
+    /*!
+     * 参照されていないノードを子孫も含めて回収します
+     *
+     * @param work 参照カウントが 0 のノードの番号
+     * @return 回収したノードの数
+     */
+    size_t reclaim(std::vector<index_type>& work) {
+        size_t n = 0;
+        while (!work.empty()) {
+            const index_type i = work.back();
+            work.pop_back();
+            node_type& m = at(i);
+            unique_table.erase(m.label, m.then_id, m.else_id);
+            for (const index_type h : {m.then_id, m.else_id}) {
+                const index_type c = id_of(h);
+                if (c >= first_id && --at(c).refs == 0) work.push_back(c);
+            }
+            m.label = std::numeric_limits<label_type>::max();
+            free_ids.push_back(i);
+            ++n;
+        }
+        return n;
+    }
+
+    /*!
+     * 置換を unique table に新しく現れた変数に広げます
+     *
+     * 新しい変数の level はラベルの値のままであり、既存の変数の level の値とは重ならないため、
+     * その値の位置に差し込みます。
+     */
+    void extend_levels() {
+        const size_t n = unique_table.label_count();
+        if (level_of.size() == n) return;
+        std::vector<std::pair<label_type, label_type>> merged;
+        merged.reserve(n);
+        for (size_t i = 0; i < label_of.size(); i++) merged.emplace_back(level_values[i], label_of[i]);
+        for (size_t k = level_of.size(); k < n; k++) {
+            const label_type l = unique_table.label(k);
+            level_of.push_back(l);
+            merged.emplace_back(l, l);
+        }
+        std::sort(merged.begin(), merged.end());
+        label_of.clear();
+        level_values.clear();
+        for (const auto& m : merged) {
+            level_values.push_back(m.first);
+            label_of.push_back(m.second);
+        }
+    }
+
+    /*!
+     * ハンドルが表す関数を変数 l で展開した2つの子を求めます
+     */
+    void cofactors(const index_type& h, const label_type& l, index_type& t, index_type& e) const {
+        if (label(h) == l) {
+            t = then_index(h);
+            e = else_index(h);
+        }
+        else {
+            t = e = h;
+        }
+    }
+
+    /*!
+     * 節点削除規則を適用してノード (l, t, e) のハンドルを返します
+     */
+    index_type make_reduced(const label_type& l, const index_type& t, const index_type& e) {
+        if (t == e) return t;
+        return make_node(l, node_ptr(this, t), node_ptr(this, e)).index();
+    }
+
+public:
+
+    /*!
+     * @brief コンストラクタ
+     */
+    arena_node_store() :
+            _size(0),
+            _dead(0),
+            permuted(false),
+            terminal_false(this, 0),
+            terminal_true(this, 1)
+    {
+        for (index_type i = 0; i < first_id; i++) {
+            node_type& n = at(allocate());
+            n.label = std::numeric_limits<label_type>::max();
+            n.then_id = n.else_id = handle_of(i, false);
+            n.refs = 0;
+        }
+    }
+
+    /*! @brief コピーは禁止されています */
+    arena_node_store(const arena_node_store&) = delete;
+    /*! @brief 代入は禁止されています */
+    arena_node_store& operator=(const arena_node_store&) = delete;
+
+    /*!
+     * @brief 0定節点を返します
+     */
+    const node_ptr& zero() const {return terminal_false;}
+    /*!
+     * @brief 1定節点を返します
+     */
+    const node_ptr& one() const {return terminal_true;}
+
+    /*!
+     * @brief ハンドルが指すノードのラベルを返します
+     */
+    const label_type& label(const index_type& h) const {
+        return at(id_of(h)).label;
+    }
+
+    /*!
+     * @brief ハンドルが表す関数の1枝側のハンドルを返します
+     */
+    index_type then_index(const index_type& h) const {
+        return at(id_of(h)).then_id ^ flip_of(h);
+    }
+
+    /*!
+     * @brief ハンドルが表す関数の0枝側のハンドルを返します
+     */
+    index_type else_index(const index_type& h) const {
+        return at(id_of(h)).else_id ^ flip_of(h);
+    }
+
+    /*!
+     * @brief 否定を表すハンドルを返します
+     *
+     * 否定枝を用いる場合のみ利用できます。
+     */
+    const node_ptr negate(const node_ptr& n) const {
+        static_assert(complement_edges, "negate() requires complement edges");
+        return node_ptr(this, n.index() ^ 1);
+    }
+
+    /*!
+     * @brief 使用中のノードの数を返します
+     *
+     * 参照されていないがまだ回収されていないノードも含みます。
+     */
+    size_t size() const {return unique_table.size();}
+
+    /*!
+     * @brief 参照されていないノードの数を返します
+     *
+     * 前回のガベージコレクション以降に参照カウントが 0 になったノードの数です。
+     * その子孫のノードは含みません。
+     */
+    size_t dead_count() const {return _dead;}
+
+    /*!
+     * @brief 参照されていないノードを回収します
+     *
+     * 回収したハンドルは新しいノードに再利用されるため、
+     * 呼び出し側は演算キャッシュを全て破棄しなければなりません。
+     * 演算の途中で呼び出してはいけません。
+     */
+    gc_statistics gc() {
+        gc_statistics s;
+        std::vector<index_type> work;
+        for (index_type i = first_id; i < _size; i++) {
+            const node_type& n = at(i);
+            if (n.refs == 0 && n.label != std::numeric_limits<label_type>::max()) {
+                work.push_back(i);
+            }
+        }
+        s.nodes = reclaim(work);
+        s.indices = s.nodes;
+        _dead = 0;
+        return s;
+    }
+
+    /*!
+     * @brief 変数の順序における位置を返します
+     *
+     * 値が小さいほど根に近い変数です。
+     * 順序を変更していないラベルと定節点のラベルはそのまま返します。
+     */
+    label_type level(const label_type& l) const {
+        if (!permuted) return l;
+        const size_t i = unique_table.slot(l);
+        return (i < level_of.size()) ? level_of[i] : l;
+    }
+
+    /*!
+     * @brief 順序を変更できる変数の数を返します
+     *
+     * ノードを生成したことのある変数の数です。
+     * 位置 0 からこの値未満の変数を swap_levels() で入れ替えられます。
+     */
+    size_t level_count() {
+        extend_levels();
+        return label_of.size();
+    }
+
+    /*!
+     * @brief ノードを生成したことのある変数の位置を返します
+     */
+    size_t position(const label_type& l) {
+        extend_levels();
+        const auto it = std::lower_bound(level_values.begin(), level_values.end(), level(l));
+        return static_cast<size_t>(it - level_values.begin());
+    }
+
+    /*!
+     * @brief 位置にある変数のラベルを返します
+     */
+    label_type label_at(const size_t i) {
+        extend_levels();
+        return label_of[i];
+    }
+
+    /*!
+     * @brief 位置にある変数のノードの数を返します
+     */
+    size_t level_size(const size_t i) {
+        return unique_table.size(label_at(i));
+    }
+
+    /*!
+     * @brief 位置 i と i + 1 の変数を入れ替えます
+     *
+     * 位置 i の変数 x のノードのうち、子に位置 i + 1 の変数 y を持つものを
+     * y のノードとしてその場で書き換え、x のノードを新たに生成して子にします。
+     * 参照されなくなった y のノードはすぐに回収します。
+     *
+     * 回収したハンドルは再利用されるため、呼び出し側は演算キャッシュを全て破棄しなければなりません。
+     * 演算の途中で呼び出してはいけません。
+     */
+    void swap_levels(const size_t i) {
+        extend_levels();
+        const label_type x = label_of[i], y = label_of[i + 1];
+        std::vector<index_type> xs, ys;
+        unique_table.level(x).for_each([&xs](const typename unique_table_type::key_type&, const index_type& id) {
+            xs.push_back(id);
+        });
+        unique_table.level(y).for_each([&ys](const typename unique_table_type::key_type&, const index_type& id) {
+            ys.push_back(id);
+        });
+
+        for (const index_type id : xs) {
+            const index_type f1 = at(id).then_id, f0 = at(id).else_id;
+            if (label(f1) != y && label(f0) != y) continue;
+            index_type f11, f10, f01, f00;
+            cofactors(f1, y, f11, f10);
+            cofactors(f0, y, f01, f00);
+            // f1 は否定でないため、その子から作る t も否定でない
+            const index_type t = make_reduced(x, f11, f01);
+            const index_type e = make_reduced(x, f10, f00);
+            unique_table.erase(x, f1, f0);
+            bool found;
+            unique_table.lookup(y, t, e, found) = id;
+            node_type& n = at(id);
+            n.label = y;
+            n.then_id = t;
+            n.else_id = e;
+            acquire(t);
+            acquire(e);
+            release(f1);
+            release(f0);
+        }
+
+        std::swap(level_of[unique_table.slot(x)], level_of[unique_table.slot(y)]);
+        std::swap(label_of[i], label_of[i + 1]);
+        permuted = true;
+
+        std::vector<index_type> work;
+        for (const index_type id : ys) {
+            if (at(id).refs == 0) {
+                work.push_back(id);
+                --_dead;
+            }
+        }
+        reclaim(work);
+    }
+
+    /*!
+     * @brief ノード (l, t, e) を返します
+     *
+     * 既に存在する場合は既存のノードを返します。
+     * 節点削除規則はこのクラスでは適用しません。
+     * 否定枝を用いる場合は、t が否定でなくなるように正規化します。
+     */
+    const node_ptr make_node(const label_type& l, const node_ptr& t, const node_ptr& e) {
+        const index_type flip = flip_of(t.index());
+        const index_type ti = t.index() ^ flip, ei = e.index() ^ flip;
+        bool found;
+        index_type& slot = unique_table.lookup(l, ti, ei, found);
+        if (!found) {
+            const index_type i = slot = allocate();
+            node_type& n = at(i);
+            n.label = l;
+            n.then_id = ti;
+            n.else_id = ei;
+            n.refs = 0;
+            ++_dead;
+            acquire(ti);
+            acquire(ei);
+        }
+        return node_ptr(this, handle_of(slot, flip != 0));
+    }
+
+    /*!
+     * @brief ノードの参照カウントを増やします
+     */
+    void acquire(const index_type& h) const {
+        const index_type i = id_of(h);
+        if (i >= first_id && at(i).refs++ == 0) --_dead;
+    }
+
+    /*!
+     * @brief ノードの参照カウントを減らします
+     */
+    void release(const index_type& h) const {
+        const index_type i = id_of(h);
+        if (i >= first_id && --at(i).refs == 0) ++_dead;
+    }
+
+    /*!
+     * @brief 演算キャッシュからノードを取り出します
+     */
+    bool load(const cache_ptr& c, node_ptr& n) const {
+        n = node_ptr(this, c);
+        return true;
+    }
+
+    /*!
+     * @brief 演算キャッシュに格納する値を生成します
+     */
+    cache_ptr save(const node_ptr& n) const {
+        return n.index();
+    }
+};
+
+template<class N>
+constexpr unsigned int arena_node_store<N>::page_bits;
+
+template<class N>
+constexpr typename arena_node_store<N>::index_type arena_node_store<N>::page_mask;
+
+template<class N>
+constexpr typename arena_node_store<N>::index_type arena_node_store<N>::first_id;
+
+template<class N>
+constexpr bool arena_node_store<N>::complement_edges;
+
+template<class N>
+constexpr bool arena_node_store<N>::concurrent;
+
+template<class N>
+constexpr bool arena_node_store<N>::reorderable;
+
+}
+
+namespace std {
+
+/*!
+ * @brief arena_node_ptr のためのハッシュ関数です
+ */
+template<class N>
+struct hash<boloq::arena_node_ptr<N>> {
+    size_t operator()(const boloq::arena_node_ptr<N>& p) const {
+        return std::hash<typename N::index_type>()(p.index());
+    }
+};
+
+}
@@ -0,0 +1,243 @@
+#pragma once
+
+namespace boloq {
+
+/*!
+ * @brief 複数の 64bit 語を1つの値として扱うビット列です
+ *
+ * 語ごとの演算を並べただけの単純なループのため、
+ * -march=native などを指定すればコンパイラが SIMD 命令に変換します。
+ *
+ * @tparam N 語の数
+ */
+template<size_t N>
+struct bit_lanes {
+    /*! @brief 下位から並べた語 */
+    uint64_t words[N];
+
+    bit_lanes() {}
+
+    /*!
+     * @brief 全ての語を v にします
+     */
+    explicit bit_lanes(const uint64_t v) {
+        for (size_t i = 0; i < N; i++) words[i] = v;
+    }
+
+    bit_lanes operator&(const bit_lanes& o) const {
+        bit_lanes r;
+        for (size_t i = 0; i < N; i++) r.words[i] = words[i] & o.words[i];
+        return r;
+    }
+
+    bit_lanes operator|(const bit_lanes& o) const {
+        bit_lanes r;
+        for (size_t i = 0; i < N; i++) r.words[i] = words[i] | o.words[i];
+        return r;
+    }
+
+    bit_lanes operator~() const {
+        bit_lanes r;
+        for (size_t i = 0; i < N; i++) r.words[i] = ~words[i];
+        return r;
+    }
+};
+
+/*! @brief 256 個の割り当てを一度に評価するためのビット列 */
+using bit_lanes256 = bit_lanes<4>;
+/*! @brief 512 個の割り当てを一度に評価するためのビット列 */
+using bit_lanes512 = bit_lanes<8>;
+
+/*!
+ * @brief ビット列を 64bit の語として読み書きするための定義です
+ */
+template<class W>
+struct lane_traits {
+    /*! @brief 語の数 */
+    static constexpr size_t words = 1;
+    static uint64_t& word(W& w, size_t) {return w;}
+};
+
+template<size_t N>
+struct lane_traits<bit_lanes<N>> {
+    static constexpr size_t words = N;
+    static uint64_t& word(bit_lanes<N>& w, const size_t i) {return w.words[i];}
+};
+
+template<class W>
+constexpr size_t lane_traits<W>::words;
+
+template<size_t N>
+constexpr size_t lane_traits<bit_lanes<N>>::words;
+
+/*!
+ * @brief 多数の割り当てに対する論理関数の値をビット並列に求めます
+ *
+ * ノードを子が先に来る順に並べた表を作り、各ノードの値を
+ * (x & then) | (~x & else) としてビット列のまま求めます。
+ * 1回の走査で W のビット数だけの割り当てを評価します。
+ *
+ * 表は生成したときの論理関数の写しであり、元の論理関数やテーブルが破棄されても使えます。
+ * 入力の列は論理関数に現れる変数だけを、ラベルの昇順に詰めて並べます。
+ * i 番目の列は labels() の i 番目の変数に対応します。
+ *
+ * @tparam T 論理関数の型
+ * @tparam W ビット列の型。uint64_t や bit_lanes256, bit_lanes512 などです
+ */
+template<class T, class W = uint64_t>
+class batch_evaluator {
+public:
+    /*! @brief ラベルの型 */
+    using label_type = typename T::label_type;
+    /*! @brief ビット列の型 */
+    using word_type = W;
+
+private:
+    using node_ptr = typename T::node_ptr;
+    using traits = lane_traits<W>;
+
+    /*!
+     * 表の各行です。変数は入力の列の位置で、子は表の位置で参照し、0 と 1 は定節点を表します
+     */
+    struct entry {
+        size_t input;
+        size_t then_pos;
+        size_t else_pos;
+    };
+
+    std::vector<entry> entries;
+    size_t root_pos;
+    std::vector<label_type> _labels;
+    std::vector<W> values;
+
+    /*!
+     * 後順に辿って表を作ります
+     */
+    struct builder {
+        using result_type = void;
+        batch_evaluator& e;
+
+        void operator()(const node_ptr& n) const {
+            if (n->is_terminal()) {
+                e.root_pos = n->index() ? 1 : 0;
+                return;
+            }
+            node_scratch<size_t> pos;
+            pos.reset();
+            const auto position = [&pos](const node_ptr& m) -> size_t {
+                if (m->is_terminal()) return m->index() ? 1 : 0;
+                return pos.get(static_cast<size_t>(m->index()));
+            };
+            std::vector<std::pair<node_ptr, bool>> stack;
+            stack.emplace_back(n, false);
+            while (!stack.empty()) {
+                const node_ptr m = stack.back().first;
+                if (pos.contains(static_cast<size_t>(m->index()))) {
+                    stack.pop_back();
+                    continue;
+                }
+                if (!stack.back().second) {
+                    stack.back().second = true;
+                    const node_ptr t = m->then_node(), f = m->else_node();
+                    if (!t->is_terminal()) stack.emplace_back(t, false);
+                    if (!f->is_terminal()) stack.emplace_back(f, false);
+                }
+                else {
+                    stack.pop_back();
+                    e.entries.push_back(entry{e._labels.size(), position(m->then_node()), position(m->else_node())});
+                    e._labels.push_back(m->label());
+                    pos.set(static_cast<size_t>(m->index()), e.entries.size() + 1);
+                }
+            }
+            e.root_pos = position(n);
+        }
+    };
+
+    /*!
+     * 行ごとに記録したラベルを、重複を除いた列の位置に置き換えます
+     */
+    void assign_inputs() {
+        const std::vector<label_type> rows(_labels);
+        std::sort(_labels.begin(), _labels.end());
+        _labels.erase(std::unique(_labels.begin(), _labels.end()), _labels.end());
+        for (auto& e : entries) {
+            const auto it = std::lower_bound(_labels.begin(), _labels.end(), rows[e.input]);
+            e.input = static_cast<size_t>(it - _labels.begin());
+        }
+    }
+
+public:
+
+    /*!
+     * @brief 論理関数から表を作ります
+     */
+    explicit batch_evaluator(const T& f) : root_pos(0) {
+        f.accept(builder{*this});
+        assign_inputs();
+        values.resize(entries.size() + 2);
+    }
+
+    /*!
+     * @brief 入力として必要な列の数を返します
+     *
+     * 論理関数に現れる変数の数です。
+     */
+    size_t input_count() const {return _labels.size();}
+
+    /*!
+     * @brief 各列に対応する変数のラベルを、列の順に返します
+     */
+    const std::vector<label_type>& labels() const {return _labels;}
+
+    /*!
+     * @brief ビット列ごとにまとめた割り当てに対する値を返します
+     *
+     * @param inputs labels() の順に並べた列。i 番目のビットが i 番目の割り当ての変数の値です
+     * @return i 番目のビットが i 番目の割り当てに対する値であるビット列
+     */
+    W evaluate(const W* inputs) {
+        values[0] = W(0);
+        values[1] = ~W(0);
+        for (size_t k = 0; k < entries.size(); k++) {
+            const entry& e = entries[k];
+            const W& x = inputs[e.input];
+            values[k + 2] = (x & values[e.then_pos]) | (~x & values[e.else_pos]);
+        }
+        return values[root_pos];
+    }
+
+    /*!
+     * @brief 列ごとにビットを詰めた任意の数の割り当てに対する値を返します
+     *
+     * @param columns labels() の順に、各割り当ての変数の値をビットに詰めた語の列を並べたもの。
+     *        各列は同じ長さでなければなりません
+     * @return 各割り当てに対する値をビットに詰めた語の列
+     */
+    std::vector<uint64_t> evaluate(const std::vector<std::vector<uint64_t>>& columns) {
+        const size_t n = input_count();
+        if (columns.size() < n) {
+            throw std::invalid_argument("boloq: batch input does not cover all variables");
+        }
+        size_t words = 0;
+        for (size_t l = 0; l < n; l++) words = std::max(words, columns[l].size());
+        if (n == 0 && !columns.empty()) words = columns[0].size();
+
+        std::vector<uint64_t> result(words);
+        std::vector<W> inputs(n);
+        for (size_t base = 0; base < words; base += traits::words) {
+            for (size_t l = 0; l < n; l++) {
+                for (size_t i = 0; i < traits::words; i++) {
+                    const size_t w = base + i;
+                    traits::word(inputs[l], i) = (w < columns[l].size()) ? columns[l][w] : 0;
+                }
+            }
+            W r = evaluate(inputs.data());
+            for (size_t i = 0; i < traits::words && base + i < words; i++) {
+                result[base + i] = traits::word(r, i);
+            }
+        }
+        return result;
+    }
+};
+
+}
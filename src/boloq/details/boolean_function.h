@@ -7,8 +7,13 @@ namespace boloq {
  */
 template<class T>
 class basic_boolean_function {
-private:
+public:
+    /*!
+     * @brief 演算に用いられるテーブル (マネージャ) の型
+     */
     using table_type = T;
+
+private:
     using self_type = basic_boolean_function<table_type>;
     friend std::hash<self_type>;
 
@@ -26,50 +31,129 @@ public:
     using label_type = typename table_type::node_type::label_type;
 
 private:
-    node_ptr _root;
+    using root_ptr = typename table_type::root_ptr;
+
+    table_type* _table;
+    root_ptr _root;
+
+    /*!
+     * 演算の結果を保持したオブジェクトを返します
+     *
+     * 結果を保持した時点では演算の途中のノードが存在しないため、
+     * 必要であればここでガベージコレクションを行います。
+     */
+    self_type hold(const node_ptr& r) const {
+        self_type f(*_table, r);
+        _table->gc_if_needed();
+        return f;
+    }
+
+    /*!
+     * 演算の結果を保持します
+     *
+     * @sa hold
+     */
+    self_type& assign(const node_ptr& r) {
+        _root = r;
+        _table->gc_if_needed();
+        return *this;
+    }
 
+    /*!
+     * 演算の相手のノードを返します
+     *
+     * 異なるテーブルに属する論理関数どうしは演算できません。
+     */
+    const node_ptr& operand(const self_type& o) const {
+        if (o._table != _table) {
+            throw std::invalid_argument("boloq: operands belong to different managers");
+        }
+        return o._root;
+    }
+
+public:
+    /*!
+     * @brief 演算に用いられるテーブルを返します
+     *
+     * 演算キャッシュの設定などに用います。
+     */
     static table_type& table() {
         static table_type instance;
         return instance;
     }
 
-public:
-
-    basic_boolean_function() : _root(nullptr) {}
+    basic_boolean_function() : _table(&table()), _root(nullptr) {}
 
     /*!
      * @brief コンストラクタ
      */
     explicit basic_boolean_function(const label_type& _label) :
-            _root(table().new_var(_label))
+            _table(&table()), _root(table().new_var(_label))
+    {}
+
+    /*!
+     * @brief テーブルを指定して変数を生成します
+     */
+    basic_boolean_function(table_type& t, const label_type& _label) :
+            _table(&t), _root(t.new_var(_label))
+    {}
+
+    /*!
+     * @brief テーブルのノードを保持します
+     */
+    basic_boolean_function(table_type& t, const node_ptr& r) :
+            _table(&t), _root(r)
     {}
 
     /*!
      * @brief visitor 内で生成するためのコンストラクタ
+     *
+     * 既定のテーブルのノードでなければなりません。
      */
     explicit basic_boolean_function(const node_ptr& r) :
-            _root(r)
+            _table(&table()), _root(r)
     {}
 
     /*!
-     * @brief 0 定節点
+     * @brief 1 定節点
      */
     static const self_type one() {
-        return self_type(table().one());
+        return one(table());
     }
 
     /*!
-     * @brief 1 定節点
+     * @brief テーブルを指定した 1 定節点
+     */
+    static const self_type one(table_type& t) {
+        return self_type(t, t.one());
+    }
+
+    /*!
+     * @brief 0 定節点
      */
     static const self_type zero() {
-        return self_type(table().zero());
+        return zero(table());
+    }
+
+    /*!
+     * @brief テーブルを指定した 0 定節点
+     */
+    static const self_type zero(table_type& t) {
+        return self_type(t, t.zero());
+    }
+
+    /*!
+     * @brief この論理関数が属するテーブルを返します
+     */
+    table_type& manager() const {
+        return *_table;
     }
 
     /*!
      * @brief ITE関数を実行します
      */
     self_type ite(const self_type& then_node, const self_type& else_node) const {
-        return self_type(table().ite(_root, then_node._root, else_node._root));
+        return hold(_table->ite(_root, operand(then_node), operand(else_node)));
     }
 
     /*!
@@ -78,7 +162,7 @@ public:
      * この判定はO(1)で行う事ができます。
      */
     bool operator==(const self_type& o) const {
-        return _root->index() == o._root->index();
+        return _table == o._table && _root->index() == o._root->index();
     }
 
     /*!
@@ -87,44 +171,42 @@ public:
      * この判定はO(1)で行う事ができます。
      */
     bool operator!=(const self_type& o) const {
-        return _root->index() != o._root->index();
+        return !(*this == o);
     }
 
     /*!
      * @brief not演算を行った結果を返します
      */
     self_type operator~() const {
-        return self_type(table().apply_not(_root));
+        return hold(_table->apply_not(_root));
     }
 
     /*!
      * @brief and演算を行った結果を返します
      */
     self_type operator&(const self_type& o) const {
-        return self_type(table().apply_and(_root, o._root));
+        return hold(_table->apply_and(_root, operand(o)));
     }
 
     /*!
      * @brief and演算を適用します
      */
     self_type& operator&=(const self_type& o) {
-        _root = table().apply_and(_root, o._root);
-        return *this;
+        return assign(_table->apply_and(_root, operand(o)));
     }
 
     /*!
      * or演算を行った結果を返します
      */
     self_type operator|(const self_type& o) const {
-        return self_type(table().apply_or(_root, o._root));
+        return hold(_table->apply_or(_root, operand(o)));
     }
 
     /*!
      * @brief or演算を適用します
      */
     self_type& operator|=(const self_type& o) {
-        _root = table().apply_or(_root, o._root);
-        return *this;
+        return assign(_table->apply_or(_root, operand(o)));
     }
 
 
@@ -132,15 +214,117 @@ public:
      * xor演算を行った結果を返します
      */
     self_type operator^(const self_type& o) const {
-        return self_type(table().apply_xor(_root, o._root));
+        return hold(_table->apply_xor(_root, operand(o)));
     }
 
     /*!
      * @brief or演算を適用します
      */
     self_type& operator^=(const self_type& o) {
-        _root = table().apply_xor(_root, o._root);
-        return *this;
+        return assign(_table->apply_xor(_root, operand(o)));
+    }
+
+    /*!
+     * @brief nand演算を行った結果を返します
+     */
+    self_type nand(const self_type& o) const {
+        return hold(_table->apply_nand(_root, operand(o)));
+    }
+
+    /*!
+     * @brief xnor演算を行った結果を返します
+     */
+    self_type xnor(const self_type& o) const {
+        return hold(_table->apply_xnor(_root, operand(o)));
+    }
+
+    /*!
+     * @brief この論理関数ならば o である (~this | o) 論理関数を返します
+     */
+    self_type implies(const self_type& o) const {
+        return hold(_table->apply_implies(_root, operand(o)));
+    }
+
+    /*!
+     * @brief 変数の集合で存在限量を行った結果を返します
+     */
+    self_type exists(const std::vector<label_type>& vars) const {
+        return hold(_table->apply_exists(_root, _table->cube(vars)));
+    }
+
+    /*!
+     * @brief 変数の集合で全称限量を行った結果を返します
+     */
+    self_type forall(const std::vector<label_type>& vars) const {
+        return hold(_table->apply_forall(_root, _table->cube(vars)));
+    }
+
+    /*!
+     * @brief この論理関数と o の積を変数の集合で存在限量した結果を返します
+     *
+     * 積を作らずに一度の走査で求めます。記号的な到達可能性解析の像の計算に用います。
+     */
+    self_type and_exists(const self_type& o, const std::vector<label_type>& vars) const {
+        return hold(_table->apply_and_exists(_root, operand(o), _table->cube(vars)));
+    }
+
+    /*!
+     * @brief 変数に値を代入した論理関数を返します
+     */
+    self_type cofactor(const label_type& v, const bool value) const {
+        return hold(_table->apply_cofactor(_root, v, value));
+    }
+
+    /*!
+     * @brief care が 1 となる割り当てでこの論理関数と一致する、小さな論理関数を返します
+     */
+    self_type restrict(const self_type& care) const {
+        return hold(_table->apply_restrict(_root, operand(care)));
+    }
+
+    /*!
+     * @brief 変数 v を論理関数 g で置き換えた論理関数を返します
+     */
+    self_type compose(const label_type& v, const self_type& g) const {
+        return hold(_table->apply_compose(_root, v, operand(g)));
+    }
+
+    /*!
+     * @brief 複数の変数を同時に論理関数で置き換えた論理関数を返します
+     *
+     * 置き換えは同時に行われるため、置き換え先に含まれる変数は置き換えられません。
+     */
+    self_type vector_compose(const std::unordered_map<label_type, self_type>& substitution) const {
+        std::vector<std::pair<label_type, node_ptr>> s;
+        s.reserve(substitution.size());
+        for (const auto& p : substitution) s.emplace_back(p.first, operand(p.second));
+        return hold(_table->apply_vector_compose(_root, s));
+    }
+
+    /*!
+     * @brief 論理関数を真にするキューブを順に返すイテレータです
+     *
+     * @sa path_iterator
+     */
+    using iterator = path_iterator<self_type, false>;
+    /*! @brief iterator と同じです */
+    using const_iterator = iterator;
+
+    /*!
+     * @brief 最初のキューブを指すイテレータを返します
+     *
+     * キューブは経路上の変数と値の組の列で、互いに交わりません。
+     * 列挙は必要になった分だけ行われます。
+     */
+    iterator begin() const {
+        return iterator(_root);
+    }
+
+    /*!
+     * @brief 終端を表すイテレータを返します
+     */
+    iterator end() const {
+        return iterator();
     }
 
     /*!
@@ -165,6 +349,30 @@ public:
         return accept(execute_visitor<self_type, AssignT>(assign));
     }
 
+    /*!
+     * @brief 多数の割り当てに対して論理関数をビット並列に評価します
+     *
+     * 同じ論理関数を繰り返し評価する場合は batch_evaluator を直接用いてください。
+     *
+     * @tparam W 一度に評価するビット列の型。uint64_t, bit_lanes256, bit_lanes512 などです
+     * @param columns 論理関数に現れる変数ごとの、各割り当ての変数の値をビットに詰めた語の列。
+     *        変数はラベルの昇順に並べます。batch_evaluator::labels() を参照してください
+     * @return 各割り当てに対する値をビットに詰めた語の列
+     */
+    template<class W = uint64_t>
+    std::vector<uint64_t> execute_batch(const std::vector<std::vector<uint64_t>>& columns) const {
+        return batch_evaluator<self_type, W>(*this).evaluate(columns);
+    }
+
+    /*!
+     * @brief 論理関数を連続した分岐表に固めます
+     *
+     * 生成した表はテーブルに依存しないため、同じ論理関数を何度も評価する場合に用います。
+     */
+    compiled_function<self_type> compile() const {
+        return compiled_function<self_type>(*this);
+    }
+
     /*!
      * @brief f(x) = x かどうかを判定します
      */
@@ -186,6 +394,31 @@ public:
         return accept(is_conjunction_visitor<self_type>());
     }
 
+    /*!
+     * @brief 論理関数を真にする割り当ての数を返します
+     *
+     * 変数の順序で先頭から nvars 個の変数についての割り当てを数えます。
+     * ノードの数に比例する時間で数えます。
+     * それ以外の変数を含む場合は std::invalid_argument を送出します。
+     *
+     * @tparam R 結果の型。count_traits を参照してください
+     */
+    template<class R = uint64_t>
+    R satcount(const size_t nvars) const {
+        satcount_visitor<self_type, R> v(*_table, nvars);
+        return accept(v);
+    }
+
+    /*!
+     * @brief 論理関数を表すノードの数を返します
+     *
+     * 定節点は含みません。
+     */
+    size_t size() const {
+        node_count_visitor<self_type> v;
+        return accept(v);
+    }
+
     /*!
      * @brief 論理和を表すかどうかを判定します
      */
@@ -197,7 +430,7 @@ public:
      * @brief 排他的論理和を表すかどうかを判定します
      */
     bool is_exclusive_disjunction() const {
-        return accept(is_exclusive_disjunction_visitor<self_type>());
+        return accept(is_exclusive_disjunction_visitor<self_type>(*_table));
     }
 
 };
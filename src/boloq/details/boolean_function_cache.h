@@ -2,6 +2,18 @@
 
 namespace boloq {
 
+/*!
+ * @brief ite の標準化によって省略された計算の数です
+ */
+struct ite_statistics {
+    /*! @brief 終端の規則によって再帰せずに求めた回数 */
+    size_t terminal_cases;
+    /*! @brief 標準化した引数で演算キャッシュにヒットした回数 */
+    size_t normalized_hits;
+
+    ite_statistics() : terminal_cases(0), normalized_hits(0) {}
+};
+
 /*!
  * @brief 基本的な演算キャッシュのテーブルです
  */
@@ -12,28 +24,61 @@ public:
     using node_type = N;
     /*! @brief このクラスが扱うノードのポインタ型 */
     using node_ptr = typename node_type::node_ptr;
+    /*! @brief 論理関数が保持するポインタ型 */
+    using root_ptr = typename node_type::root_ptr;
 
 private:
     using self_type = basic_boolean_function_cache<N>;
 
+    using store_type = typename node_type::store_type;
     using index_type = typename node_type::index_type;
     using label_type = typename node_type::label_type;
 
-    using unique_key_type = const std::tuple<label_type, index_type, index_type>;
     using compute_key_type = const std::tuple<index_type, index_type, index_type>;
+    using bin_op_key_type = const std::tuple<index_type, index_type>;
+
+    using cache_ptr = typename store_type::cache_ptr;
 
-    using cache_ptr = std::weak_ptr<const typename node_ptr::element_type>;
+    static constexpr bool complement = store_type::complement_edges;
+    static constexpr bool concurrent = store_type::concurrent;
+    static constexpr bool reorderable = store_type::reorderable;
 
-    using unique_table_type = std::unordered_map<unique_key_type, cache_ptr>;
-    using compute_table_type = std::unordered_map<compute_key_type, cache_ptr>;
+    template<class K>
+    using cache_table = typename std::conditional<concurrent,
+          concurrent_operation_cache<K, cache_ptr>,
+          operation_cache<K, cache_ptr>>::type;
 
-    const node_type __terminal_false, __terminal_true;
-    const node_ptr terminal_false, terminal_true;
+    using compute_table_type = cache_table<compute_key_type>;
+    using bin_op_table_type = cache_table<bin_op_key_type>;
 
-    index_generator<unique_key_type, index_type> igen;
+    store_type store;
 
-    unique_table_type unique_table;
     compute_table_type compute_table;
+    bin_op_table_type and_table;
+    bin_op_table_type or_table;
+    bin_op_table_type xor_table;
+    bin_op_table_type nand_table;
+    bin_op_table_type xnor_table;
+    bin_op_table_type implies_table;
+    bin_op_table_type exists_table;
+    bin_op_table_type forall_table;
+    compute_table_type and_exists_table;
+    bin_op_table_type restrict_table;
+    compute_table_type compose_table;
+    ite_statistics ite_stats;
+
+    double gc_ratio;
+    size_t gc_min_nodes;
+
+    std::unique_ptr<work_stealing_pool> pool;
+    size_t spawn_depth;
+
+    /*! 変数のラベルからグループの番号への対応 */
+    std::unordered_map<label_type, size_t> variable_group;
+    size_t group_count;
+    bool auto_reorder;
+    size_t reorder_min_nodes;
+    size_t next_reorder;
 
     const node_ptr next_then_node(const node_ptr& n, const label_type& label) const {
         if (n->label() != label) return n;
@@ -46,10 +91,750 @@ private:
     }
 
     /*!
-     * unique tableのための検索キーを生成します
+     * 否定枝を用いる場合は O(1) で否定を求めます
+     */
+    const node_ptr negate(const node_ptr& a, std::true_type) {
+        return store.negate(a);
+    }
+
+    const node_ptr negate(const node_ptr& a, std::false_type) {
+        return ite(a, zero(), one());
+    }
+
+    /*!
+     * 否定枝を持つノードなら true を返します
+     *
+     * 否定枝を用いない場合は常に false です。
+     */
+    static bool is_complemented(const node_ptr& n) {
+        return complement && !(n->index() & 1);
+    }
+
+    /*!
+     * 変数の順序における位置を返します
+     */
+    label_type level_of(const node_ptr& n) const {
+        return store.level(n->label());
+    }
+
+    /*!
+     * 変数の順序が先の方のラベルを返します
+     */
+    label_type top_label(const node_ptr& a, const node_ptr& b) const {
+        return (level_of(a) <= level_of(b)) ? a->label() : b->label();
+    }
+
+    /*!
+     * 可換な引数を並べ替えるための順序です
+     *
+     * 変数の順序が先のものを優先し、同じ変数なら否定を除いたインデックスで比べます。
+     */
+    bool precedes(const node_ptr& a, const node_ptr& b) const {
+        if (a->label() != b->label()) return level_of(a) < level_of(b);
+        const index_type mask = complement ? 1 : 0;
+        return (a->index() | mask) < (b->index() | mask);
+    }
+
+    /*!
+     * ノードの数が前回の変更後の2倍になっていれば変数の順序を変更します
+     */
+    bool reorder_if_needed(std::true_type) {
+        if (!auto_reorder || store.size() < next_reorder) return false;
+        reorder();
+        return true;
+    }
+
+    bool reorder_if_needed(std::false_type) {
+        return false;
+    }
+
+    /*!
+     * ite の終端の規則を適用します
+     *
+     * @return 再帰せずに結果が求まれば true
+     */
+    bool ite_terminal(const node_ptr& f, const node_ptr& g, const node_ptr& h, node_ptr& r) {
+        if (f->is_terminal()) r = f->index() ? g : h;
+        else if (g == h) r = g;                                     // ite(f, g, g) = g
+        else if (g == one() && h == zero()) r = f;                  // ite(f, 1, 0) = f
+        else if (complement && g == zero() && h == one()) r = apply_not(f); // ite(f, 0, 1) = ~f
+        else return false;
+        // スレッド間でカウンタを共有しないよう、並列に演算を行う場合は数えない
+        if (!concurrent) ++ite_stats.terminal_cases;
+        return true;
+    }
+
+    struct resize_table {
+        size_t log2_size;
+        template<class TableT>
+        void operator()(TableT& t) const {t.resize(log2_size);}
+    };
+
+    struct set_table_auto_resize {
+        size_t max_log2_size;
+        double min_hit_ratio;
+        template<class TableT>
+        void operator()(TableT& t) const {t.set_auto_resize(max_log2_size, min_hit_ratio);}
+    };
+
+    struct clear_table {
+        size_t& n;
+        template<class TableT>
+        void operator()(TableT& t) const {n += t.clear();}
+    };
+
+    struct sum_table_statistics {
+        operation_cache_statistics& s;
+        template<class TableT>
+        void operator()(TableT& t) const {s += t.statistics();}
+    };
+
+    /*!
+     * 全ての演算キャッシュに関数を適用します
      */
-    static unique_key_type make_unique_key(const label_type& l, const node_ptr& t, const node_ptr& e) {
-        return unique_key_type(l, t->index(), e->index());
+    template<class F>
+    void for_each_table(const F& f) {
+        f(compute_table);
+        f(and_table);
+        f(or_table);
+        f(xor_table);
+        f(nand_table);
+        f(xnor_table);
+        f(implies_table);
+        f(exists_table);
+        f(forall_table);
+        f(and_exists_table);
+        f(restrict_table);
+        f(compose_table);
+    }
+
+    /*!
+     * 二項演算の定義です
+     *
+     * 各演算は終端の規則、引数の交換可能性、使用する演算キャッシュを定めます。
+     * normalize は否定枝を取り除けるときに結果を否定するかどうかを返します。
+     */
+    struct and_op {
+        static constexpr bool commutative = true;
+        static bin_op_table_type& table(self_type& c) {return c.and_table;}
+        static bool normalize(self_type&, node_ptr&, node_ptr&) {return false;}
+        static bool terminal(self_type& c, const node_ptr& a, const node_ptr& b, node_ptr& r) {
+            if (a == c.zero() || b == c.zero()) r = c.zero();
+            else if (a == c.one() || a == b) r = b;
+            else if (b == c.one()) r = a;
+            else if (complement && a == c.apply_not(b)) r = c.zero();
+            else return false;
+            return true;
+        }
+    };
+
+    struct or_op {
+        static constexpr bool commutative = true;
+        static bin_op_table_type& table(self_type& c) {return c.or_table;}
+        static bool normalize(self_type&, node_ptr&, node_ptr&) {return false;}
+        static bool terminal(self_type& c, const node_ptr& a, const node_ptr& b, node_ptr& r) {
+            if (a == c.one() || b == c.one()) r = c.one();
+            else if (a == c.zero() || a == b) r = b;
+            else if (b == c.zero()) r = a;
+            else return false;
+            return true;
+        }
+    };
+
+    struct xor_op {
+        static constexpr bool commutative = true;
+        static bin_op_table_type& table(self_type& c) {return c.xor_table;}
+        // ~a ^ b = ~(a ^ b)
+        static bool normalize(self_type& c, node_ptr& a, node_ptr& b) {
+            bool negated = false;
+            if (is_complemented(a)) { a = c.apply_not(a); negated = !negated; }
+            if (is_complemented(b)) { b = c.apply_not(b); negated = !negated; }
+            return negated;
+        }
+        static bool terminal(self_type& c, const node_ptr& a, const node_ptr& b, node_ptr& r) {
+            if (a == b) r = c.zero();
+            else if (a == c.zero()) r = b;
+            else if (b == c.zero()) r = a;
+            else return false;
+            return true;
+        }
+    };
+
+    struct nand_op {
+        static constexpr bool commutative = true;
+        static bin_op_table_type& table(self_type& c) {return c.nand_table;}
+        static bool normalize(self_type&, node_ptr&, node_ptr&) {return false;}
+        static bool terminal(self_type& c, const node_ptr& a, const node_ptr& b, node_ptr& r) {
+            if (a == c.zero() || b == c.zero()) r = c.one();
+            else if (a == c.one() && b == c.one()) r = c.zero();
+            else return false;
+            return true;
+        }
+    };
+
+    struct xnor_op {
+        static constexpr bool commutative = true;
+        static bin_op_table_type& table(self_type& c) {return c.xnor_table;}
+        static bool normalize(self_type&, node_ptr&, node_ptr&) {return false;}
+        static bool terminal(self_type& c, const node_ptr& a, const node_ptr& b, node_ptr& r) {
+            if (a == b) r = c.one();
+            else if (a == c.one()) r = b;
+            else if (b == c.one()) r = a;
+            else if (a->is_terminal() && b->is_terminal()) r = c.zero();
+            else return false;
+            return true;
+        }
+    };
+
+    struct implies_op {
+        static constexpr bool commutative = false;
+        static bin_op_table_type& table(self_type& c) {return c.implies_table;}
+        static bool normalize(self_type&, node_ptr&, node_ptr&) {return false;}
+        static bool terminal(self_type& c, const node_ptr& a, const node_ptr& b, node_ptr& r) {
+            if (a == c.zero() || b == c.one() || a == b) r = c.one();
+            else if (a == c.one()) r = b;
+            else return false;
+            return true;
+        }
+    };
+
+    /*!
+     * 二項演算のフレームに保持される引数です
+     */
+    struct bin_op_operands {
+        node_ptr p, q;
+        label_type v;
+        bool negated;
+    };
+
+    /*!
+     * 二項演算を明示的なスタックで適用するための手順です
+     *
+     * ite を経由せず、2つのインデックスの組を演算キャッシュのキーにします。
+     */
+    template<class Op>
+    struct bin_op_step {
+        self_type& c;
+
+        bool resolve(bin_op_operands& x, node_ptr& r) {
+            if (Op::terminal(c, x.p, x.q, r)) return true;
+            x.negated = Op::normalize(c, x.p, x.q);
+            if (x.negated && Op::terminal(c, x.p, x.q, r)) {
+                r = c.apply_not(r);
+                return true;
+            }
+            // 可換な演算は引数を並べ替えてキャッシュのエントリを共有する
+            if (Op::commutative && c.precedes(x.q, x.p)) std::swap(x.p, x.q);
+            // 計算済みなら計算結果を返す
+            if (c.find_cache(Op::table(c), make_bin_op_key(x.p, x.q), r)) {
+                if (x.negated) r = c.apply_not(r);
+                return true;
+            }
+            x.v = c.top_label(x.p, x.q);
+            return false;
+        }
+
+        size_t expand(const bin_op_operands& x, bin_op_operands* sub) const {
+            sub[0] = bin_op_operands{c.next_then_node(x.p, x.v), c.next_then_node(x.q, x.v), x.v, false};
+            sub[1] = bin_op_operands{c.next_else_node(x.p, x.v), c.next_else_node(x.q, x.v), x.v, false};
+            return 2;
+        }
+
+        node_ptr combine(const bin_op_operands& x, const node_ptr* r) {
+            // ルールに従ってノードをスキップする
+            const node_ptr n = (r[0] == r[1]) ? r[0] : c.new_var(x.v, r[0], r[1]);
+            Op::table(c).insert(make_bin_op_key(x.p, x.q), c.store.save(n));
+            return x.negated ? c.apply_not(n) : n;
+        }
+    };
+
+    /*!
+     * ite のフレームに保持される引数です
+     */
+    struct ite_operands {
+        node_ptr f, g, h;
+        label_type v;
+        bool negated;
+    };
+
+    /*!
+     * ite を明示的なスタックで適用するための手順です
+     */
+    struct ite_step {
+        self_type& c;
+
+        bool resolve(ite_operands& x, node_ptr& r) {
+            return c.resolve_ite(x, r);
+        }
+
+        size_t expand(const ite_operands& x, ite_operands* sub) const {
+            sub[0] = ite_operands{c.next_then_node(x.f, x.v),
+                                  c.next_then_node(x.g, x.v),
+                                  c.next_then_node(x.h, x.v), x.v, false};
+            sub[1] = ite_operands{c.next_else_node(x.f, x.v),
+                                  c.next_else_node(x.g, x.v),
+                                  c.next_else_node(x.h, x.v), x.v, false};
+            return 2;
+        }
+
+        node_ptr combine(const ite_operands& x, const node_ptr* r) {
+            // ルールに従ってノードをスキップする
+            // ノード (v, T, E) が存在しないなら新しいノードを生成
+            const node_ptr n = (r[0] == r[1]) ? r[0] : c.new_var(x.v, r[0], r[1]);
+            // 計算結果を登録
+            c.compute_table.insert(make_compute_key(x.f, x.g, x.h), c.store.save(n));
+            return x.negated ? c.apply_not(n) : n;
+        }
+    };
+
+    /*!
+     * 限量の定義です
+     *
+     * merge は量化する変数で展開した2つの子をまとめます。
+     */
+    struct exists_op {
+        static bin_op_table_type& table(self_type& c) {return c.exists_table;}
+        static const node_ptr merge(self_type& c, const node_ptr& a, const node_ptr& b) {
+            return c.apply_or(a, b);
+        }
+    };
+
+    struct forall_op {
+        static bin_op_table_type& table(self_type& c) {return c.forall_table;}
+        static const node_ptr merge(self_type& c, const node_ptr& a, const node_ptr& b) {
+            return c.apply_and(a, b);
+        }
+    };
+
+    /*!
+     * 限量のフレームに保持される引数です
+     *
+     * cube は量化する変数の正リテラルの積です。
+     */
+    struct quantify_operands {
+        node_ptr f, cube;
+        label_type v;
+        bool quantify;
+    };
+
+    /*!
+     * 限量を明示的なスタックで適用するための手順です
+     */
+    template<class Op>
+    struct quantify_step {
+        self_type& c;
+
+        bool resolve(quantify_operands& x, node_ptr& r) {
+            if (x.f->is_terminal()) {
+                r = x.f;
+                return true;
+            }
+            x.cube = c.skip_cube(x.cube, c.level_of(x.f));
+            if (x.cube->is_terminal()) {
+                r = x.f;
+                return true;
+            }
+            if (c.find_cache(Op::table(c), make_bin_op_key(x.f, x.cube), r)) return true;
+            x.v = x.f->label();
+            x.quantify = (x.cube->label() == x.v);
+            return false;
+        }
+
+        size_t expand(const quantify_operands& x, quantify_operands* sub) const {
+            const node_ptr cube = x.quantify ? x.cube->then_node() : x.cube;
+            sub[0] = quantify_operands{x.f->then_node(), cube, x.v, false};
+            sub[1] = quantify_operands{x.f->else_node(), cube, x.v, false};
+            return 2;
+        }
+
+        node_ptr combine(const quantify_operands& x, const node_ptr* r) {
+            node_ptr n;
+            if (x.quantify) n = Op::merge(c, r[0], r[1]);
+            else n = (r[0] == r[1]) ? r[0] : c.new_var(x.v, r[0], r[1]);
+            Op::table(c).insert(make_bin_op_key(x.f, x.cube), c.store.save(n));
+            return n;
+        }
+    };
+
+    /*!
+     * and と存在限量を同時に行うフレームに保持される引数です
+     */
+    struct and_exists_operands {
+        node_ptr f, g, cube;
+        label_type v;
+        bool quantify;
+    };
+
+    /*!
+     * f & g を作らずに、積を求めながら存在限量を行う手順です
+     */
+    struct and_exists_step {
+        self_type& c;
+
+        bool resolve(and_exists_operands& x, node_ptr& r) {
+            node_ptr& f = x.f;
+            node_ptr& g = x.g;
+            if (f == c.zero() || g == c.zero()) r = c.zero();
+            else if (f == c.one() && g == c.one()) r = c.one();
+            else if (complement && f == c.apply_not(g)) r = c.zero();
+            else if (f == c.one()) r = c.apply_exists(g, x.cube);
+            else if (g == c.one() || f == g) r = c.apply_exists(f, x.cube);
+            else {
+                if (c.precedes(g, f)) std::swap(f, g);
+                const label_type top = std::min(c.level_of(f), c.level_of(g));
+                x.cube = c.skip_cube(x.cube, top);
+                if (x.cube->is_terminal()) {
+                    r = c.apply_and(f, g);
+                    return true;
+                }
+                if (c.find_cache(c.and_exists_table, make_compute_key(f, g, x.cube), r)) return true;
+                x.v = c.top_label(f, g);
+                x.quantify = (x.cube->label() == x.v);
+                return false;
+            }
+            return true;
+        }
+
+        size_t expand(const and_exists_operands& x, and_exists_operands* sub) const {
+            const node_ptr cube = x.quantify ? x.cube->then_node() : x.cube;
+            sub[0] = and_exists_operands{c.next_then_node(x.f, x.v), c.next_then_node(x.g, x.v), cube, x.v, false};
+            sub[1] = and_exists_operands{c.next_else_node(x.f, x.v), c.next_else_node(x.g, x.v), cube, x.v, false};
+            return 2;
+        }
+
+        node_ptr combine(const and_exists_operands& x, const node_ptr* r) {
+            node_ptr n;
+            if (x.quantify) n = c.apply_or(r[0], r[1]);
+            else n = (r[0] == r[1]) ? r[0] : c.new_var(x.v, r[0], r[1]);
+            c.and_exists_table.insert(make_compute_key(x.f, x.g, x.cube), c.store.save(n));
+            return n;
+        }
+    };
+
+    /*!
+     * restrict のフレームに保持される引数です
+     *
+     * branch は展開する子を表し、0 なら両方、1 なら1枝のみ、2 なら0枝のみです。
+     */
+    struct restrict_operands {
+        node_ptr f, care;
+        label_type v;
+        unsigned char branch;
+    };
+
+    /*!
+     * Coudert と Madre の restrict を明示的なスタックで適用するための手順です
+     *
+     * care が 0 となる割り当てでは f の値を自由に選び、ノードが少なくなるようにします。
+     */
+    struct restrict_step {
+        self_type& c;
+
+        bool resolve(restrict_operands& x, node_ptr& r) {
+            node_ptr& f = x.f;
+            node_ptr& care = x.care;
+            while (true) {
+                if (care == c.zero() || care == c.one() || f->is_terminal()) r = f;
+                else if (f == care) r = c.one();
+                else if (complement && f == c.apply_not(care)) r = c.zero();
+                else if (c.level_of(care) < c.level_of(f)) {
+                    // f が依存しない変数は care から取り除く
+                    care = c.apply_or(care->then_node(), care->else_node());
+                    continue;
+                }
+                else break;
+                return true;
+            }
+            if (c.find_cache(c.restrict_table, make_bin_op_key(f, care), r)) return true;
+            x.v = f->label();
+            x.branch = 0;
+            if (care->label() == x.v) {
+                if (care->else_node() == c.zero()) x.branch = 1;
+                else if (care->then_node() == c.zero()) x.branch = 2;
+            }
+            return false;
+        }
+
+        size_t expand(const restrict_operands& x, restrict_operands* sub) const {
+            const node_ptr care1 = c.next_then_node(x.care, x.v), care0 = c.next_else_node(x.care, x.v);
+            if (x.branch == 1) {
+                sub[0] = restrict_operands{x.f->then_node(), care1, x.v, 0};
+                return 1;
+            }
+            if (x.branch == 2) {
+                sub[0] = restrict_operands{x.f->else_node(), care0, x.v, 0};
+                return 1;
+            }
+            sub[0] = restrict_operands{x.f->then_node(), care1, x.v, 0};
+            sub[1] = restrict_operands{x.f->else_node(), care0, x.v, 0};
+            return 2;
+        }
+
+        node_ptr combine(const restrict_operands& x, const node_ptr* r) {
+            node_ptr n = r[0];
+            if (x.branch == 0 && r[0] != r[1]) n = c.new_var(x.v, r[0], r[1]);
+            c.restrict_table.insert(make_bin_op_key(x.f, x.care), c.store.save(n));
+            return n;
+        }
+    };
+
+    /*!
+     * compose のフレームに保持される引数です
+     *
+     * var は置き換える変数の正リテラルです。
+     */
+    struct compose_operands {
+        node_ptr f, var, g;
+    };
+
+    /*!
+     * 変数を論理関数で置き換える手順です
+     */
+    struct compose_step {
+        self_type& c;
+
+        bool resolve(compose_operands& x, node_ptr& r) {
+            if (x.f->is_terminal() || c.level_of(x.f) > c.level_of(x.var)) {
+                r = x.f;
+                return true;
+            }
+            if (c.find_cache(c.compose_table, make_compute_key(x.f, x.var, x.g), r)) return true;
+            if (x.f->label() == x.var->label()) {
+                r = c.ite(x.g, x.f->then_node(), x.f->else_node());
+                c.compose_table.insert(make_compute_key(x.f, x.var, x.g), c.store.save(r));
+                return true;
+            }
+            return false;
+        }
+
+        size_t expand(const compose_operands& x, compose_operands* sub) const {
+            sub[0] = compose_operands{x.f->then_node(), x.var, x.g};
+            sub[1] = compose_operands{x.f->else_node(), x.var, x.g};
+            return 2;
+        }
+
+        node_ptr combine(const compose_operands& x, const node_ptr* r) {
+            // 子は f の変数より先の変数を含むことがあるため ite で合成する
+            const node_ptr n = c.ite(c.new_var(x.f->label()), r[0], r[1]);
+            c.compose_table.insert(make_compute_key(x.f, x.var, x.g), c.store.save(n));
+            return n;
+        }
+    };
+
+    /*!
+     * 複数の変数を同時に置き換える手順です
+     *
+     * 置き換えの組ごとに結果が異なるため、演算キャッシュではなく呼び出しごとの表に記録します。
+     */
+    struct vector_compose_step {
+        using entry = std::pair<label_type, node_ptr>;
+
+        self_type& c;
+        /*! 置き換える変数の位置と置き換え先の組を、位置の順に並べたもの */
+        const std::vector<entry>& substitution;
+        std::unordered_map<index_type, node_ptr>& memo;
+
+        bool resolve(node_ptr& f, node_ptr& r) {
+            if (f->is_terminal() || c.level_of(f) > substitution.back().first) {
+                r = f;
+                return true;
+            }
+            const auto it = memo.find(f->index());
+            if (it == memo.end()) return false;
+            r = it->second;
+            return true;
+        }
+
+        size_t expand(const node_ptr& f, node_ptr* sub) const {
+            sub[0] = f->then_node();
+            sub[1] = f->else_node();
+            return 2;
+        }
+
+        node_ptr combine(const node_ptr& f, const node_ptr* r) {
+            const label_type lv = c.level_of(f);
+            const auto it = std::lower_bound(substitution.begin(), substitution.end(), lv,
+                    [](const entry& e, const label_type& v) {return e.first < v;});
+            const bool found = it != substitution.end() && it->first == lv;
+            const node_ptr g = found ? it->second : c.new_var(f->label());
+            const node_ptr n = c.ite(g, r[0], r[1]);
+            memo.emplace(f->index(), n);
+            return n;
+        }
+    };
+
+    /*!
+     * 変数の順序が level より先にある変数を cube から取り除きます
+     */
+    const node_ptr skip_cube(node_ptr cube, const label_type& level) const {
+        while (!cube->is_terminal() && level_of(cube) < level) cube = cube->then_node();
+        return cube;
+    }
+
+    using ite_stack_type = apply_stack<ite_operands, node_ptr>;
+    using bin_op_stack_type = apply_stack<bin_op_operands, node_ptr>;
+    using quantify_stack_type = apply_stack<quantify_operands, node_ptr>;
+    using and_exists_stack_type = apply_stack<and_exists_operands, node_ptr>;
+    using restrict_stack_type = apply_stack<restrict_operands, node_ptr>;
+    using compose_stack_type = apply_stack<compose_operands, node_ptr>;
+    using vector_compose_stack_type = apply_stack<node_ptr, node_ptr>;
+
+    /*!
+     * スレッドごとのエンジンを返します
+     *
+     * 同じスレッドの入れ子の呼び出しはスタックの続きを用いるため、テーブルの間で共有できます。
+     */
+    static ite_stack_type& ite_stack() {
+        static thread_local ite_stack_type s;
+        return s;
+    }
+
+    static bin_op_stack_type& bin_op_stack() {
+        static thread_local bin_op_stack_type s;
+        return s;
+    }
+
+    static quantify_stack_type& quantify_stack() {
+        static thread_local quantify_stack_type s;
+        return s;
+    }
+
+    static and_exists_stack_type& and_exists_stack() {
+        static thread_local and_exists_stack_type s;
+        return s;
+    }
+
+    static restrict_stack_type& restrict_stack() {
+        static thread_local restrict_stack_type s;
+        return s;
+    }
+
+    static compose_stack_type& compose_stack() {
+        static thread_local compose_stack_type s;
+        return s;
+    }
+
+    static vector_compose_stack_type& vector_compose_stack() {
+        static thread_local vector_compose_stack_type s;
+        return s;
+    }
+
+    /*!
+     * スレッドの数が設定されていれば上位の階層を並列に、そうでなければ逐次に演算を適用します
+     */
+    template<class Stack, class Step>
+    const node_ptr run(Stack& (*local)(), Step step, const typename Stack::operands_type& x) {
+        if (pool) return parallel_apply(*pool, local, step, x, spawn_depth);
+        return local().run(step, x);
+    }
+
+    /*!
+     * ite の引数を標準形に変換し、終端の規則と演算キャッシュを適用します
+     *
+     * @return 結果が求まれば true
+     */
+    bool resolve_ite(ite_operands& x, node_ptr& r) {
+        node_ptr& f = x.f;
+        node_ptr& g = x.g;
+        node_ptr& h = x.h;
+        if (ite_terminal(f, g, h, r)) return true;
+
+        // ite(f, f, h) = ite(f, 1, h), ite(f, g, f) = ite(f, g, 0)
+        bool normalized = true;
+        if (f == g) g = one();
+        else if (f == h) h = zero();
+        else if (complement && g == apply_not(f)) g = zero();
+        else if (complement && h == apply_not(f)) h = one();
+        else normalized = false;
+        if (normalized && ite_terminal(f, g, h, r)) return true;
+
+        // 可換な演算は先に現れる変数を条件側に置く
+        if (g == one()) {
+            // f | h = ite(h, 1, f)
+            if (precedes(h, f)) { std::swap(f, h); normalized = true; }
+        }
+        else if (h == zero()) {
+            // f & g = ite(g, f, 0)
+            if (precedes(g, f)) { std::swap(f, g); normalized = true; }
+        }
+        else if (complement && g == zero()) {
+            // ~f & h = ite(~h, 0, ~f)
+            if (precedes(h, f)) {
+                const node_ptr t = f;
+                f = apply_not(h);
+                h = apply_not(t);
+                normalized = true;
+            }
+        }
+        else if (complement && h == one()) {
+            // ~f | g = ite(~g, ~f, 1)
+            if (precedes(g, f)) {
+                const node_ptr t = f;
+                f = apply_not(g);
+                g = apply_not(t);
+                normalized = true;
+            }
+        }
+        else if (complement && g == apply_not(h)) {
+            // ite(f, g, ~g) = ite(g, f, ~f)
+            if (precedes(g, f)) {
+                std::swap(f, g);
+                h = apply_not(g);
+                normalized = true;
+            }
+        }
+
+        // 否定枝を用いる場合は f と g を否定のない枝にする
+        bool& negated = x.negated;
+        negated = false;
+        if (complement && is_complemented(f)) {
+            // ite(~f, g, h) = ite(f, h, g)
+            f = apply_not(f);
+            std::swap(g, h);
+            normalized = true;
+        }
+        if (complement && is_complemented(g)) {
+            // ite(f, g, h) = ~ite(f, ~g, ~h)
+            g = apply_not(g);
+            h = apply_not(h);
+            negated = true;
+            normalized = true;
+        }
+
+        // 計算済みなら計算結果を返す
+        if (find_cache(compute_table, make_compute_key(f, g, h), r)) {
+            if (!concurrent && normalized) ++ite_stats.normalized_hits;
+            if (negated) r = apply_not(r);
+            return true;
+        }
+
+        x.v = (level_of(f) <= level_of(g)) ? top_label(f, h) : top_label(g, h);
+        return false;
+
+    }
+
+    /*!
+     * 二項演算を適用します
+     */
+    template<class Op>
+    const node_ptr apply_bin_op(const node_ptr& a, const node_ptr& b) {
+        return run(&bin_op_stack, bin_op_step<Op>{*this}, bin_op_operands{a, b, label_type(), false});
+    }
+
+    /*!
+     * 演算キャッシュから計算結果を検索します
+     */
+    template<class TableT, class KeyT>
+    bool find_cache(TableT& table, const KeyT& key, node_ptr& r) const {
+        cache_ptr c;
+        return table.find(key, c) && store.load(c, r);
+    }
+
+    /*!
+     * 二項演算のための検索キーを生成します
+     */
+    static bin_op_key_type make_bin_op_key(const node_ptr& p, const node_ptr& q) {
+        return std::make_tuple(p->index(), q->index());
     }
 
     /*!
@@ -64,10 +849,9 @@ public:
     /*!
      * @brief コンストラクタ
      */
-    constexpr basic_boolean_function_cache() :
-            __terminal_false(0), __terminal_true(1),
-            terminal_false(&__terminal_false, null_deleter()),
-            terminal_true(&__terminal_true, null_deleter())
+    basic_boolean_function_cache() :
+            gc_ratio(0.5), gc_min_nodes(1 << 16), spawn_depth(0),
+            group_count(0), auto_reorder(false), reorder_min_nodes(0), next_reorder(0)
     {}
 
     /*! @brief コピーは禁止されています */
@@ -78,26 +862,208 @@ public:
     /*!
      * @brief 0定節点を返します
      */
-    const node_ptr& zero() const {return terminal_false;}
+    const node_ptr& zero() const {return store.zero();}
     /*!
      * @brief 1定節点を返します
      */
-    const node_ptr& one() const {return terminal_true;}
+    const node_ptr& one() const {return store.one();}
+
+    /*!
+     * @brief 使用中のノードの数を返します
+     *
+     * 参照されていないがまだ回収されていないノードも含みます。
+     */
+    size_t size() const {return store.size();}
+
+    /*!
+     * @brief 演算ごとのキャッシュのエントリ数を変更します
+     *
+     * @param log2_size エントリ数の2を底とする対数
+     */
+    void set_cache_size(const size_t log2_size) {
+        for_each_table(resize_table{log2_size});
+    }
+
+    /*!
+     * @brief 演算キャッシュの自動拡張の設定を変更します
+     *
+     * @sa operation_cache::set_auto_resize
+     */
+    void set_cache_auto_resize(const size_t max_log2_size, const double min_hit_ratio = 0.3) {
+        for_each_table(set_table_auto_resize{max_log2_size, min_hit_ratio});
+    }
+
+    /*!
+     * @brief 全ての演算キャッシュの統計情報を合算して返します
+     */
+    operation_cache_statistics cache_statistics() {
+        operation_cache_statistics s;
+        for_each_table(sum_table_statistics{s});
+        return s;
+    }
+
+    /*!
+     * @brief 参照されていないノードを回収します
+     *
+     * インデックスが再利用される場合は演算キャッシュも破棄します。
+     * 演算の途中で呼び出してはいけません。
+     */
+    gc_statistics gc() {
+        gc_statistics s = store.gc();
+        if (s.indices > 0) for_each_table(clear_table{s.cache_entries});
+        return s;
+    }
+
+    /*!
+     * @brief 自動的にガベージコレクションを行う条件を設定します
+     *
+     * @param ratio 解放されたノードの割合がこれを超えると回収します。1 以上なら自動では回収しません
+     * @param min_nodes ノードの数がこれ未満なら回収しません
+     */
+    void set_gc_threshold(const double ratio, const size_t min_nodes = 1 << 16) {
+        gc_ratio = ratio;
+        gc_min_nodes = min_nodes;
+    }
+
+    /*!
+     * @brief 演算に用いるスレッドの数を設定します
+     *
+     * 2 以上を設定すると、ite と二項演算の上位の階層をワークスティーリングで並列に計算します。
+     * 複数のスレッドから同時に操作できるノードを用いる場合のみ利用できます。
+     * 演算の途中で呼び出してはいけません。
+     *
+     * @param n 呼び出し元のスレッドを含めたスレッドの数
+     */
+    void set_threads(const size_t n) {
+        static_assert(concurrent, "set_threads() requires a concurrent node store");
+        pool.reset();
+        if (n <= 1) return;
+        pool.reset(new work_stealing_pool(n));
+        // 負荷の偏りを均すため、スレッドの数より十分多くのタスクに分割する
+        spawn_depth = 4;
+        for (size_t m = 1; m < n; m <<= 1) spawn_depth++;
+    }
+
+    /*!
+     * @brief 演算に用いるスレッドの数を返します
+     */
+    size_t threads() const {
+        return pool ? pool->size() : 1;
+    }
+
+    /*!
+     * @brief unique table のスロット数を変更します
+     *
+     * 複数のスレッドから同時に操作できるノードを用いる場合のみ利用できます。
+     * 演算の途中で呼び出してはいけません。
+     *
+     * @sa concurrent_arena_node_store::reserve
+     */
+    void reserve(const size_t log2_slots) {
+        store.reserve(log2_slots);
+    }
+
+    /*!
+     * @brief 条件を満たしていればガベージコレクションを行います
+     *
+     * 自動的な変数の順序の変更が有効であれば、その条件もここで調べます。
+     * 演算の途中で呼び出してはいけません。
+     *
+     * @return 回収を行えば true
+     */
+    bool gc_if_needed() {
+        // 順序の変更はガベージコレクションを含む
+        if (reorder_if_needed(std::integral_constant<bool, reorderable>())) return true;
+        const size_t n = store.size();
+        if (n < gc_min_nodes || store.dead_count() <= gc_ratio * n) return false;
+        gc();
+        return true;
+    }
+
+    /*!
+     * @brief 変数の順序における位置を返します
+     *
+     * 位置が小さいほど根に近い変数です。順序を変更するまではラベルの順に並びます。
+     */
+    label_type level(const label_type& l) const {
+        return store.level(l);
+    }
+
+    /*!
+     * @brief sifting で変数の順序を変更します
+     *
+     * ガベージコレクションを行ってから、ノードをその場で書き換えて変数を入れ替えます。
+     * 保持されている論理関数はそのまま同じ関数を表します。演算キャッシュは全て破棄します。
+     * 順序を変更できるノードを用いる場合のみ利用できます。
+     * 演算の途中で呼び出してはいけません。
+     */
+    reorder_statistics reorder() {
+        static_assert(reorderable, "reorder() requires a reorderable node store");
+        gc();
+        const reorder_statistics s = variable_sifter<store_type>(store, variable_group).run();
+        size_t n = 0;
+        for_each_table(clear_table{n});
+        next_reorder = std::max(reorder_min_nodes, 2 * s.nodes_after);
+        return s;
+    }
+
+    /*!
+     * @brief ノードの数が前回の変更後の2倍を超えたら、自動的に変数の順序を変更します
+     *
+     * 順序の変更は論理関数が演算の結果を保持した時点で行われます。
+     *
+     * @param enabled 自動的に変更するかどうか
+     * @param min_nodes ノードの数がこれ未満なら変更しません
+     */
+    void set_auto_reorder(const bool enabled, const size_t min_nodes = 1 << 12) {
+        static_assert(reorderable, "set_auto_reorder() requires a reorderable node store");
+        auto_reorder = enabled;
+        reorder_min_nodes = min_nodes;
+        next_reorder = std::max(min_nodes, 2 * store.size());
+    }
+
+    /*!
+     * @brief 変数をグループにまとめます
+     *
+     * グループの変数は順序の上で連続するように移動され、
+     * 以後の sifting ではブロックとして一緒に動き、中の順序は保たれます。
+     * ビットベクタの各ビットなどをまとめるのに用います。
+     * 既に他のグループに属する変数を含む場合は std::invalid_argument を送出します。
+     * 演算の途中で呼び出してはいけません。
+     */
+    void group_variables(const std::vector<label_type>& labels) {
+        static_assert(reorderable, "group_variables() requires a reorderable node store");
+        if (labels.empty()) return;
+        for (const label_type l : labels) {
+            if (variable_group.count(l) != 0) {
+                throw std::invalid_argument("boloq: variable already belongs to a group");
+            }
+        }
+        // 全ての変数に位置を割り当てるため、ノードを生成しておく
+        for (const label_type l : labels) new_var(l);
+        ++group_count;
+        std::vector<std::pair<size_t, label_type>> members;
+        for (const label_type l : labels) {
+            variable_group[l] = group_count;
+            members.emplace_back(store.position(l), l);
+        }
+        std::sort(members.begin(), members.end());
+        // 先頭の変数の直後へ順に持ち上げる
+        gc();
+        for (size_t k = 1; k < members.size(); k++) {
+            for (size_t i = store.position(members[k].second); i > members[0].first + k; i--) {
+                store.swap_levels(i - 1);
+            }
+        }
+        size_t n = 0;
+        for_each_table(clear_table{n});
+    }
 
     /*!
      * @brief 新しいノードを生成します
      */
     const node_ptr new_var(const label_type& _label, const node_ptr& t, const node_ptr& e) {
-        // もうすでに存在するなら既存のノードを返す
-        const unique_key_type key = make_unique_key(_label, t, e);
-        const auto it = unique_table.find(key);
-        if (it != unique_table.end() && !it->second.expired()) {
-            return it->second.lock();
-        }
-        // 存在しなければ新しく生成
-        const node_ptr pf(new node_type(igen.get_index(key) + 2, _label, t, e));
-        unique_table[key] = pf; // 登録
-        return pf;
+        return store.make_node(_label, t, e);
     }
 
     /*!
@@ -109,69 +1075,191 @@ public:
 
     /*!
      * if-then-else に基づいてBDDをマージする
+     *
+     * 演算キャッシュを引く前に引数を標準形に変換するため、
+     * a & b と b & a のように等価な呼び出しは同じエントリを共有します。
      */
     const node_ptr ite(const node_ptr& if_node, const node_ptr& then_node, const node_ptr& else_node) {
         // if_node が終端なら then_node もしくは else_node を定義どおりに返す
         if (if_node->is_terminal()) {
             return (if_node->index()) ? then_node : else_node;
         }
+        return run(&ite_stack, ite_step{*this}, ite_operands{if_node, then_node, else_node, label_type(), false});
+    }
 
-        // 計算済みなら計算結果を返す
-        const compute_key_type compute_key = make_compute_key(if_node, then_node, else_node);
-        const auto it = compute_table.find(compute_key);
-        if (it != compute_table.end() && !it->second.expired()) {
-            return it->second.lock();
-        }
-
-        const label_type& v = std::min(if_node->label(),
-                                      std::min(then_node->label(),
-                                               else_node->label()));
-
-        // 子を計算
-        const node_ptr then_child = ite(next_then_node(if_node, v),
-                                        next_then_node(then_node, v),
-                                        next_then_node(else_node, v));
-        const node_ptr else_child = ite(next_else_node(if_node, v),
-                                        next_else_node(then_node, v),
-                                        next_else_node(else_node, v));
-
-        // ルールに従ってノードをスキップする
-        if (then_child == else_child) return then_child;
-
-        // ノード (v, T, E) が存在しないなら新しいノードを生成
-        const node_ptr unique = new_var(v, then_child, else_child);
-        // 計算結果を登録
-        compute_table[compute_key] = unique;
-        return unique;
+    /*!
+     * @brief ite の標準化の統計情報を返します
+     */
+    ite_statistics normalization_statistics() const {
+        return ite_stats;
     }
 
     /*!
      * @brief not を適用した結果を返します
      */
     const node_ptr apply_not(const node_ptr& a) {
-        return ite(a, zero(), one());
+        return negate(a, std::integral_constant<bool, store_type::complement_edges>());
     }
 
     /*!
      * @brief and を適用した結果を返します
      */
     const node_ptr apply_and(const node_ptr& a, const node_ptr& b) {
-        return ite(a, b, zero());
+        return apply_bin_op<and_op>(a, b);
     }
 
     /*!
      * @brief or を適用した結果を返します
+     *
+     * 否定枝を用いる場合は a | b = ~(~a & ~b) として and のキャッシュを共有します。
      */
     const node_ptr apply_or(const node_ptr& a, const node_ptr& b) {
-        return ite(a, one(), b);
+        if (complement) return apply_not(apply_and(apply_not(a), apply_not(b)));
+        return apply_bin_op<or_op>(a, b);
     }
 
     /*!
-     * @brief or を適用した結果を返します
+     * @brief xor を適用した結果を返します
      */
     const node_ptr apply_xor(const node_ptr& a, const node_ptr& b) {
-        return ite(a, apply_not(b), b);
+        return apply_bin_op<xor_op>(a, b);
+    }
+
+    /*!
+     * @brief nand を適用した結果を返します
+     */
+    const node_ptr apply_nand(const node_ptr& a, const node_ptr& b) {
+        if (complement) return apply_not(apply_and(a, b));
+        return apply_bin_op<nand_op>(a, b);
+    }
+
+    /*!
+     * @brief xnor を適用した結果を返します
+     */
+    const node_ptr apply_xnor(const node_ptr& a, const node_ptr& b) {
+        if (complement) return apply_not(apply_xor(a, b));
+        return apply_bin_op<xnor_op>(a, b);
+    }
+
+    /*!
+     * @brief a ならば b (~a | b) を適用した結果を返します
+     */
+    const node_ptr apply_implies(const node_ptr& a, const node_ptr& b) {
+        if (complement) return apply_not(apply_and(a, apply_not(b)));
+        return apply_bin_op<implies_op>(a, b);
+    }
+
+    /*!
+     * @brief 変数の正リテラルの積を返します
+     *
+     * 限量で量化する変数の集合を表すのに用います。
+     */
+    const node_ptr cube(const std::vector<label_type>& labels) {
+        std::vector<label_type> sorted(labels);
+        // 根に近い変数が最後になるように並べ、下から作る
+        std::sort(sorted.begin(), sorted.end(), [this](const label_type& a, const label_type& b) {
+            return store.level(a) > store.level(b);
+        });
+        sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+        node_ptr r = one();
+        for (const label_type& l : sorted) r = new_var(l, r, zero());
+        return r;
+    }
+
+    /*!
+     * @brief cube に含まれる変数で存在限量を行った結果を返します
+     *
+     * @param a 論理関数
+     * @param cube 量化する変数の正リテラルの積
+     */
+    const node_ptr apply_exists(const node_ptr& a, const node_ptr& cube) {
+        return run(&quantify_stack, quantify_step<exists_op>{*this},
+                   quantify_operands{a, cube, label_type(), false});
+    }
+
+    /*!
+     * @brief cube に含まれる変数で全称限量を行った結果を返します
+     *
+     * 否定枝を用いる場合は ~exists(~a) として存在限量のキャッシュを共有します。
+     *
+     * @sa apply_exists
+     */
+    const node_ptr apply_forall(const node_ptr& a, const node_ptr& cube) {
+        if (complement) return apply_not(apply_exists(apply_not(a), cube));
+        return run(&quantify_stack, quantify_step<forall_op>{*this},
+                   quantify_operands{a, cube, label_type(), false});
+    }
+
+    /*!
+     * @brief a & b を cube に含まれる変数で存在限量した結果を返します
+     *
+     * 積を求めながら量化するため、a & b 全体を生成しません。
+     *
+     * @sa apply_exists
+     */
+    const node_ptr apply_and_exists(const node_ptr& a, const node_ptr& b, const node_ptr& cube) {
+        return run(&and_exists_stack, and_exists_step{*this},
+                   and_exists_operands{a, b, cube, label_type(), false});
+    }
+
+    /*!
+     * @brief 変数に値を代入した結果を返します
+     *
+     * restrict と演算キャッシュを共有します。
+     */
+    const node_ptr apply_cofactor(const node_ptr& a, const label_type& _label, const bool value) {
+        const node_ptr literal = value ? new_var(_label) : new_var(_label, zero(), one());
+        return apply_restrict(a, literal);
+    }
+
+    /*!
+     * @brief care が 1 となる割り当てで a と一致する、小さな論理関数を返します
+     *
+     * Coudert と Madre の restrict です。care が定数なら a をそのまま返します。
+     */
+    const node_ptr apply_restrict(const node_ptr& a, const node_ptr& care) {
+        return run(&restrict_stack, restrict_step{*this}, restrict_operands{a, care, label_type(), 0});
+    }
+
+    /*!
+     * @brief a の変数を論理関数 g で置き換えた結果を返します
+     */
+    const node_ptr apply_compose(const node_ptr& a, const label_type& _label, const node_ptr& g) {
+        return run(&compose_stack, compose_step{*this}, compose_operands{a, new_var(_label), g});
+    }
+
+    /*!
+     * @brief a の複数の変数を同時に論理関数で置き換えた結果を返します
+     *
+     * 一度の走査で全ての変数を置き換えます。
+     * 呼び出しごとの表に記録するため、並列には実行しません。
+     *
+     * @param a 論理関数
+     * @param substitution 置き換える変数のラベルと置き換え先の論理関数の組
+     */
+    const node_ptr apply_vector_compose(const node_ptr& a,
+                                        const std::vector<std::pair<label_type, node_ptr>>& substitution) {
+        if (substitution.empty()) return a;
+        // 位置で引けるように並べ替える
+        std::vector<std::pair<label_type, node_ptr>> by_level;
+        by_level.reserve(substitution.size());
+        for (const auto& p : substitution) by_level.emplace_back(store.level(p.first), p.second);
+        std::sort(by_level.begin(), by_level.end(),
+                [](const std::pair<label_type, node_ptr>& x, const std::pair<label_type, node_ptr>& y) {
+            return x.first < y.first;
+        });
+        std::unordered_map<index_type, node_ptr> memo;
+        return vector_compose_stack().run(vector_compose_step{*this, by_level, memo}, a);
     }
 };
 
+template<class N>
+constexpr bool basic_boolean_function_cache<N>::complement;
+
+template<class N>
+constexpr bool basic_boolean_function_cache<N>::concurrent;
+
+template<class N>
+constexpr bool basic_boolean_function_cache<N>::reorderable;
+
 }
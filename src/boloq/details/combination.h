@@ -7,8 +7,13 @@ namespace boloq {
  */
 template<class T>
 class basic_combination {
-private:
+public:
+    /*!
+     * @brief 演算に用いられるテーブル (マネージャ) の型
+     */
     using table_type = T;
+
+private:
     using self_type = basic_combination<table_type>;
     friend std::hash<self_type>;
 
@@ -26,69 +31,141 @@ public:
     using label_type = typename table_type::node_type::label_type;
 
 private:
-    node_ptr _root;
+    using root_ptr = typename table_type::root_ptr;
 
-    explicit basic_combination(const node_ptr& r) :
-            _root(r)
-    {}
+    table_type* _table;
+    root_ptr _root;
+
+    /*!
+     * 演算の結果を保持したオブジェクトを返します
+     *
+     * 結果を保持した時点では演算の途中のノードが存在しないため、
+     * 必要であればここでガベージコレクションを行います。
+     */
+    self_type hold(const node_ptr& r) const {
+        self_type f(*_table, r);
+        _table->gc_if_needed();
+        return f;
+    }
 
+    /*!
+     * 演算の結果を保持します
+     *
+     * @sa hold
+     */
+    self_type& assign(const node_ptr& r) {
+        _root = r;
+        _table->gc_if_needed();
+        return *this;
+    }
+
+    /*!
+     * 演算の相手のノードを返します
+     *
+     * 異なるテーブルに属する組み合わせ集合どうしは演算できません。
+     */
+    const node_ptr& operand(const self_type& o) const {
+        if (o._table != _table) {
+            throw std::invalid_argument("boloq: operands belong to different managers");
+        }
+        return o._root;
+    }
+
+public:
+    /*!
+     * @brief 演算に用いられるテーブルを返します
+     *
+     * 演算キャッシュの設定などに用います。
+     */
     static table_type& table() {
         static table_type instance;
         return instance;
     }
 
-public:
-
-    basic_combination() : _root(nullptr) {}
+    basic_combination() : _table(&table()), _root(nullptr) {}
 
     /*!
      * @brief コンストラクタ
      */
     explicit basic_combination(const label_type& _label) :
-            _root(table().new_var(_label))
+            _table(&table()), _root(table().new_var(_label))
     {}
 
     /*!
-     * @brief 0 定節点
+     * @brief テーブルを指定して変数を生成します
+     */
+    basic_combination(table_type& t, const label_type& _label) :
+            _table(&t), _root(t.new_var(_label))
+    {}
+
+    /*!
+     * @brief テーブルのノードを保持します
+     */
+    basic_combination(table_type& t, const node_ptr& r) :
+            _table(&t), _root(r)
+    {}
+
+    /*!
+     * @brief 1 定節点
      */
     static const self_type one() {
-        return self_type(table().one());
+        return one(table());
     }
 
     /*!
-     * @brief 1 定節点
+     * @brief テーブルを指定した 1 定節点
+     */
+    static const self_type one(table_type& t) {
+        return self_type(t, t.one());
+    }
+
+    /*!
+     * @brief 0 定節点
      */
     static const self_type zero() {
-        return self_type(table().zero());
+        return zero(table());
+    }
+
+    /*!
+     * @brief テーブルを指定した 0 定節点
+     */
+    static const self_type zero(table_type& t) {
+        return self_type(t, t.zero());
+    }
+
+    /*!
+     * @brief この組み合わせ集合が属するテーブルを返します
+     */
+    table_type& manager() const {
+        return *_table;
     }
 
     /*!
      * @brief v を含まない組合せを集めた部分集合を返す
      */
     self_type offset(const label_type& v) {
-        return self_type(table().apply_offset(_root, v));
+        return hold(_table->apply_offset(_root, v));
     }
 
     /*!
      * @brief v を含む組合せから v を取り除いた集合を返す
      */
     self_type onset(const label_type& v) {
-        return self_type(table().apply_onset(_root, v));
+        return hold(_table->apply_onset(_root, v));
     }
 
     /*!
      * @brief 特定のアイテムの存在を反転させます
      */
     self_type& change(const label_type& v) {
-        _root = table().apply_change(_root, v);
-        return *this;
+        return assign(_table->apply_change(_root, v));
     }
 
     /*!
      * @brief 特定のアイテムの存在を反転させた結果を返します
      */
     self_type changed(const label_type& v) {
-        return self_type(table().apply_change(_root, v));
+        return hold(_table->apply_change(_root, v));
     }
 
     /*!
@@ -97,7 +174,7 @@ public:
      * この判定はO(1)で行う事ができます。
      */
     bool operator==(const self_type& o) const {
-        return _root->index() == o._root->index();
+        return _table == o._table && _root->index() == o._root->index();
     }
 
     /*!
@@ -106,71 +183,125 @@ public:
      * この判定はO(1)で行う事ができます。
      */
     bool operator!=(const self_type& o) const {
-        return _root->index() != o._root->index();
+        return !(*this == o);
     }
 
     /*!
      * @brief union を行った結果を返します
      */
     self_type operator+(const self_type& o) const {
-        return self_type(table().apply_union(_root, o._root));
+        return hold(_table->apply_union(_root, operand(o)));
     }
 
     /*!
      * @brief union を適用します
      */
     self_type& operator+=(const self_type& o) {
-        _root = table().apply_union(_root, o.root);
-        return *this;
+        return assign(_table->apply_union(_root, operand(o)));
     }
 
     /*!
      * @brief subtract を行った結果を返します
      */
     self_type operator-(const self_type& o) const {
-        return self_type(table().apply_subtract(_root, o._root));
+        return hold(_table->apply_subtract(_root, operand(o)));
     }
 
     /*!
      * @brief subtract を適用します
      */
     self_type& operator-=(const self_type& o) {
-        _root = table().apply_subtract(_root, o.root);
-        return *this;
+        return assign(_table->apply_subtract(_root, operand(o)));
     }
 
     /*!
      * @brief intersection の結果を返します
      */
     self_type operator&(const self_type& o) const {
-        return self_type(table().apply_intersection(_root, o._root));
+        return hold(_table->apply_intersection(_root, operand(o)));
     }
 
     /*!
      * @brief intersection を適用します
      */
     self_type& operator&=(const self_type& o) {
-        _root = table().apply_intersection(_root, o._root);
-        return *this;
+        return assign(_table->apply_intersection(_root, operand(o)));
     }
 
     /*!
      * @brief join を行った結果を返します
      */
     self_type operator*(const self_type& o) const {
-        return self_type(table().apply_join(_root, o._root));
+        return hold(_table->apply_join(_root, operand(o)));
     }
 
     /*!
      * @brief join を適用します
      */
     self_type& operator*=(const self_type& o) {
-        _root = table().apply_join(_root, o.root);
-        return *this;
+        return assign(_table->apply_join(_root, operand(o)));
+    }
+
+    /*!
+     * @brief 弱除算の商を返します
+     *
+     * 商と o の join が元の集合に含まれるような最大の集合で、o のアイテムを含みません。
+     * o が空集合の場合は std::invalid_argument を送出します。
+     */
+    self_type operator/(const self_type& o) const {
+        return hold(_table->apply_divide(_root, operand(o)));
+    }
+
+    /*!
+     * @brief 弱除算の商を代入します
+     */
+    self_type& operator/=(const self_type& o) {
+        return assign(_table->apply_divide(_root, operand(o)));
+    }
+
+    /*!
+     * @brief 弱除算の剰余を返します
+     *
+     * *this == (*this / o) * o + *this % o が成り立ちます。
+     */
+    self_type operator%(const self_type& o) const {
+        return hold(_table->apply_remainder(_root, operand(o)));
+    }
+
+    /*!
+     * @brief 弱除算の剰余を代入します
+     */
+    self_type& operator%=(const self_type& o) {
+        return assign(_table->apply_remainder(_root, operand(o)));
     }
 
     self_type meet(const self_type& o) const {
-        return self_type(table().apply_meet(_root, o._root));
+        return hold(_table->apply_meet(_root, operand(o)));
+    }
+
+    /*!
+     * @brief 組み合わせ集合の要素を順に返すイテレータです
+     *
+     * @sa path_iterator
+     */
+    using iterator = path_iterator<self_type, true>;
+    /*! @brief iterator と同じです */
+    using const_iterator = iterator;
+
+    /*!
+     * @brief 最初の要素を指すイテレータを返します
+     *
+     * 要素はアイテムのラベルの列です。列挙は必要になった分だけ行われます。
+     */
+    iterator begin() const {
+        return iterator(_root);
+    }
+
+    /*!
+     * @brief 終端を表すイテレータを返します
+     */
+    iterator end() const {
+        return iterator();
     }
 
     /*!
@@ -187,6 +318,19 @@ public:
         return _root->accept(visitor);
     }
 
+    /*!
+     * @brief 組み合わせ集合の要素数を返します
+     *
+     * ノードの数に比例する時間で数えます。
+     *
+     * @tparam R 結果の型。count_traits を参照してください
+     */
+    template<class R = uint64_t>
+    R count() const {
+        count_visitor<self_type, R> v;
+        return accept(v);
+    }
+
     /*!
      * @brief 組み合わせ集合を評価します
      */
@@ -12,38 +12,449 @@ public:
     using node_type = N;
     /*! @brief このクラスが扱うノードのポインタ型 */
     using node_ptr = typename node_type::node_ptr;
+    /*! @brief 組み合わせ集合が保持するポインタ型 */
+    using root_ptr = typename node_type::root_ptr;
 
 private:
     using self_type = basic_combination_cache<N>;
 
+    using store_type = typename node_type::store_type;
+    static_assert(!store_type::complement_edges, "ZDD does not support complement edges");
     using index_type = typename node_type::index_type;
     using label_type = typename node_type::label_type;
 
-    using unique_key_type = const std::tuple<label_type, index_type, index_type>;
     using change_key_type = const std::tuple<index_type, label_type>;
     using bin_op_key_type = const std::tuple<index_type, index_type>;
 
-    using cache_ptr = std::weak_ptr<typename node_ptr::element_type>;
+    using cache_ptr = typename store_type::cache_ptr;
 
-    index_generator<unique_key_type, index_type> igen;
+    static constexpr bool concurrent = store_type::concurrent;
 
-    std::unordered_map<unique_key_type, cache_ptr> unique_table;
-    std::unordered_map<change_key_type, cache_ptr> offset_table;
-    std::unordered_map<change_key_type, cache_ptr> onset_table;
-    std::unordered_map<change_key_type, cache_ptr> change_table;
-    std::unordered_map<bin_op_key_type, cache_ptr> union_table;
-    std::unordered_map<bin_op_key_type, cache_ptr> intersection_table;
-    std::unordered_map<bin_op_key_type, cache_ptr> join_table;
-    std::unordered_map<bin_op_key_type, cache_ptr> meet_table;
+    template<class K>
+    using cache_table = typename std::conditional<concurrent,
+          concurrent_operation_cache<K, cache_ptr>,
+          operation_cache<K, cache_ptr>>::type;
 
-    const node_type __terminal_false, __terminal_true;
-    const node_ptr terminal_false, terminal_true;
+    using change_table_type = cache_table<change_key_type>;
+    using bin_op_table_type = cache_table<bin_op_key_type>;
+
+    store_type store;
+
+    double gc_ratio;
+    size_t gc_min_nodes;
+
+    std::unique_ptr<work_stealing_pool> pool;
+    size_t spawn_depth;
+
+    change_table_type offset_table;
+    change_table_type onset_table;
+    change_table_type change_table;
+    bin_op_table_type union_table;
+    bin_op_table_type intersection_table;
+    bin_op_table_type subtract_table;
+    bin_op_table_type divide_table;
+    bin_op_table_type remainder_table;
+    bin_op_table_type join_table;
+    bin_op_table_type meet_table;
+
+    /*!
+     * 演算キャッシュから計算結果を検索します
+     */
+    template<class TableT, class KeyT>
+    bool find_cache(TableT& table, const KeyT& key, node_ptr& r) const {
+        cache_ptr c;
+        return table.find(key, c) && store.load(c, r);
+    }
+
+    struct resize_table {
+        size_t log2_size;
+        template<class TableT>
+        void operator()(TableT& t) const {t.resize(log2_size);}
+    };
+
+    struct set_table_auto_resize {
+        size_t max_log2_size;
+        double min_hit_ratio;
+        template<class TableT>
+        void operator()(TableT& t) const {t.set_auto_resize(max_log2_size, min_hit_ratio);}
+    };
+
+    struct clear_table {
+        size_t& n;
+        template<class TableT>
+        void operator()(TableT& t) const {n += t.clear();}
+    };
+
+    struct sum_table_statistics {
+        operation_cache_statistics& s;
+        template<class TableT>
+        void operator()(TableT& t) const {s += t.statistics();}
+    };
+
+    /*!
+     * 全ての演算キャッシュに関数を適用します
+     */
+    template<class F>
+    void for_each_table(const F& f) {
+        f(offset_table);
+        f(onset_table);
+        f(change_table);
+        f(union_table);
+        f(intersection_table);
+        f(subtract_table);
+        f(divide_table);
+        f(remainder_table);
+        f(join_table);
+        f(meet_table);
+    }
+
+    /*!
+     * 1つのアイテムに対する演算のフレームに保持される引数です
+     */
+    struct change_operands {
+        node_ptr n;
+        label_type v;
+    };
+
+    /*!
+     * 1つのアイテムに対する演算の定義です
+     *
+     * terminal はノードのラベルが v 以上のときの結果を返します。
+     */
+    struct offset_op {
+        static change_table_type& table(self_type& c) {return c.offset_table;}
+        static node_ptr terminal(self_type&, const node_ptr& n, const label_type& v) {
+            return (n->label() == v) ? n->else_node() : n;
+        }
+    };
+
+    struct onset_op {
+        static change_table_type& table(self_type& c) {return c.onset_table;}
+        static node_ptr terminal(self_type& c, const node_ptr& n, const label_type& v) {
+            return (n->label() == v) ? n->then_node() : c.zero();
+        }
+    };
+
+    struct change_op {
+        static change_table_type& table(self_type& c) {return c.change_table;}
+        static node_ptr terminal(self_type& c, const node_ptr& n, const label_type& v) {
+            if (n->label() == v) return c.new_var(v, n->else_node(), n->then_node());
+            return c.new_var(v, n, c.zero());
+        }
+    };
+
+    /*!
+     * 1つのアイテムに対する演算を明示的なスタックで適用するための手順です
+     */
+    template<class Op>
+    struct change_step {
+        self_type& c;
+
+        bool resolve(change_operands& x, node_ptr& r) {
+            if (x.n->label() >= x.v) {
+                r = Op::terminal(c, x.n, x.v);
+                return true;
+            }
+            return c.find_cache(Op::table(c), make_change_key(x.n, x.v), r);
+        }
+
+        size_t expand(const change_operands& x, change_operands* sub) const {
+            sub[0] = change_operands{x.n->then_node(), x.v};
+            sub[1] = change_operands{x.n->else_node(), x.v};
+            return 2;
+        }
+
+        node_ptr combine(const change_operands& x, const node_ptr* r) {
+            const node_ptr n = c.new_var(x.n->label(), r[0], r[1]);
+            Op::table(c).insert(make_change_key(x.n, x.v), c.store.save(n));
+            return n;
+        }
+    };
+
+    /*!
+     * 二項演算のフレームに保持される引数です
+     */
+    struct bin_op_operands {
+        node_ptr p, q;
+        label_type v;
+    };
+
+    /*!
+     * 和集合を明示的なスタックで求めるための手順です
+     */
+    struct union_step {
+        self_type& c;
+
+        bool resolve(bin_op_operands& x, node_ptr& r) {
+            if (x.p == c.zero()) r = x.q;
+            else if (x.q == c.zero() || x.p == x.q) r = x.p;
+            else return c.find_cache(c.union_table, make_bin_op_key(x.p, x.q), r);
+            return true;
+        }
+
+        size_t expand(bin_op_operands& x, bin_op_operands* sub) const {
+            const node_ptr& p = x.p;
+            const node_ptr& q = x.q;
+            if (p->label() < q->label()) {
+                x.v = p->label();
+                sub[0] = bin_op_operands{p->then_node(), c.zero(), x.v};
+                sub[1] = bin_op_operands{p->else_node(), q, x.v};
+            }
+            else if (p->label() > q->label()) {
+                x.v = q->label();
+                sub[0] = bin_op_operands{q->then_node(), c.zero(), x.v};
+                sub[1] = bin_op_operands{p, q->else_node(), x.v};
+            }
+            else {
+                x.v = p->label();
+                sub[0] = bin_op_operands{p->then_node(), q->then_node(), x.v};
+                sub[1] = bin_op_operands{p->else_node(), q->else_node(), x.v};
+            }
+            return 2;
+        }
+
+        node_ptr combine(const bin_op_operands& x, const node_ptr* r) {
+            const node_ptr n = c.new_var(x.v, r[0], r[1]);
+            c.union_table.insert(make_bin_op_key(x.p, x.q), c.store.save(n));
+            return n;
+        }
+    };
+
+    /*!
+     * 積集合を明示的なスタックで求めるための手順です
+     */
+    struct intersection_step {
+        self_type& c;
+
+        bool resolve(bin_op_operands& x, node_ptr& r) {
+            if (x.p == c.zero() || x.q == c.zero()) r = c.zero();
+            else if (x.p == x.q) r = x.p;
+            else return c.find_cache(c.intersection_table, make_bin_op_key(x.p, x.q), r);
+            return true;
+        }
+
+        size_t expand(bin_op_operands& x, bin_op_operands* sub) const {
+            const node_ptr& p = x.p;
+            const node_ptr& q = x.q;
+            x.v = p->label();
+            if (p->label() < q->label()) {
+                sub[0] = bin_op_operands{p->else_node(), q, x.v};
+                return 1;
+            }
+            if (p->label() > q->label()) {
+                sub[0] = bin_op_operands{q->else_node(), p, x.v};
+                return 1;
+            }
+            sub[0] = bin_op_operands{p->then_node(), q->then_node(), x.v};
+            sub[1] = bin_op_operands{p->else_node(), q->else_node(), x.v};
+            return 2;
+        }
+
+        node_ptr combine(const bin_op_operands& x, const node_ptr* r) {
+            const node_ptr n = (x.p->label() == x.q->label()) ? c.new_var(x.v, r[0], r[1]) : r[0];
+            c.intersection_table.insert(make_bin_op_key(x.p, x.q), c.store.save(n));
+            return n;
+        }
+    };
+
+    /*!
+     * 差集合を明示的なスタックで求めるための手順です
+     */
+    struct subtract_step {
+        self_type& c;
+
+        bool resolve(bin_op_operands& x, node_ptr& r) {
+            if (x.p == c.zero() || x.p == x.q) r = c.zero();
+            else if (x.q == c.zero()) r = x.p;
+            else return c.find_cache(c.subtract_table, make_bin_op_key(x.p, x.q), r);
+            return true;
+        }
+
+        size_t expand(bin_op_operands& x, bin_op_operands* sub) const {
+            const node_ptr& p = x.p;
+            const node_ptr& q = x.q;
+            if (p->label() > q->label()) {
+                // q の先頭のアイテムを含む要素は p にない
+                x.v = q->label();
+                sub[0] = bin_op_operands{p, q->else_node(), x.v};
+                return 1;
+            }
+            x.v = p->label();
+            if (p->label() < q->label()) {
+                sub[0] = bin_op_operands{p->then_node(), c.zero(), x.v};
+                sub[1] = bin_op_operands{p->else_node(), q, x.v};
+            }
+            else {
+                sub[0] = bin_op_operands{p->then_node(), q->then_node(), x.v};
+                sub[1] = bin_op_operands{p->else_node(), q->else_node(), x.v};
+            }
+            return 2;
+        }
+
+        node_ptr combine(const bin_op_operands& x, const node_ptr* r) {
+            const node_ptr n = (x.p->label() > x.q->label()) ? r[0] : c.new_var(x.v, r[0], r[1]);
+            c.subtract_table.insert(make_bin_op_key(x.p, x.q), c.store.save(n));
+            return n;
+        }
+    };
 
     /*!
-     * unique tableのための検索キーを生成します
+     * 弱除算を明示的なスタックで求めるための手順です
+     *
+     * 除数の先頭のアイテム v で f = v f1 + f0, g = v g1 + g0 と分解すると、
+     * 商は f1 / g1 と f0 / g0 の積集合です。g0 が空集合なら f1 / g1 です。
      */
-    static unique_key_type make_unique_key(const label_type& l, const node_ptr& t, const node_ptr& e) {
-        return std::make_tuple(l, t->index(), e->index());
+    struct divide_step {
+        self_type& c;
+
+        bool resolve(bin_op_operands& x, node_ptr& r) {
+            if (x.q == c.one()) r = x.p;
+            else if (x.p == x.q) r = c.one();
+            else if (x.p == c.zero() || x.p == c.one()) r = c.zero();
+            else return c.find_cache(c.divide_table, make_bin_op_key(x.p, x.q), r);
+            return true;
+        }
+
+        size_t expand(bin_op_operands& x, bin_op_operands* sub) const {
+            const node_ptr& g = x.q;
+            x.v = g->label();
+            sub[0] = bin_op_operands{c.apply_onset(x.p, x.v), g->then_node(), x.v};
+            if (g->else_node() == c.zero()) return 1;
+            sub[1] = bin_op_operands{c.apply_offset(x.p, x.v), g->else_node(), x.v};
+            return 2;
+        }
+
+        node_ptr combine(const bin_op_operands& x, const node_ptr* r) {
+            const node_ptr n = (x.q->else_node() == c.zero()) ? r[0] : c.apply_intersection(r[0], r[1]);
+            c.divide_table.insert(make_bin_op_key(x.p, x.q), c.store.save(n));
+            return n;
+        }
+    };
+
+    /*!
+     * join を明示的なスタックで求めるための手順です
+     *
+     * 先頭のアイテム v で f = v f1 + f0 と分解し、結果のノードを直接生成します。
+     * g も v で始まる場合、v を含む要素は f1 * (g1 + g0) と f0 * g1 の和集合、
+     * 含まない要素は f0 * g0 です。そうでなければ v f1 * g + f0 * g です。
+     */
+    struct join_step {
+        self_type& c;
+
+        bool resolve(bin_op_operands& x, node_ptr& r) {
+            if (x.p == c.zero() || x.q == c.zero()) r = c.zero();
+            else if (x.p == c.one()) r = x.q;
+            else if (x.q == c.one()) r = x.p;
+            else {
+                const bool swapped = (x.p->label() != x.q->label()) ?
+                    x.q->label() < x.p->label() :
+                    x.q->index() < x.p->index();
+                if (swapped) std::swap(x.p, x.q);
+                return c.find_cache(c.join_table, make_bin_op_key(x.p, x.q), r);
+            }
+            return true;
+        }
+
+        size_t expand(bin_op_operands& x, bin_op_operands* sub) const {
+            const node_ptr& f = x.p;
+            const node_ptr& g = x.q;
+            x.v = f->label();
+            const node_ptr f1 = f->then_node(), f0 = f->else_node();
+            if (f->label() == g->label()) {
+                const node_ptr g1 = g->then_node(), g0 = g->else_node();
+                sub[0] = bin_op_operands{f1, c.apply_union(g1, g0), x.v};
+                sub[1] = bin_op_operands{f0, g1, x.v};
+                sub[2] = bin_op_operands{f0, g0, x.v};
+                return 3;
+            }
+            sub[0] = bin_op_operands{f1, g, x.v};
+            sub[1] = bin_op_operands{f0, g, x.v};
+            return 2;
+        }
+
+        node_ptr combine(const bin_op_operands& x, const node_ptr* r) {
+            const node_ptr n = (x.p->label() == x.q->label()) ?
+                c.new_var(x.v, c.apply_union(r[0], r[1]), r[2]) :
+                c.new_var(x.v, r[0], r[1]);
+            c.join_table.insert(make_bin_op_key(x.p, x.q), c.store.save(n));
+            return n;
+        }
+    };
+
+    /*!
+     * meet を明示的なスタックで求めるための手順です
+     *
+     * g も v で始まる場合、v を含む要素は f1 . g1、
+     * 含まない要素は (f1 + f0) . g0 と f0 . g1 の和集合です。
+     * そうでなければ v は結果に現れないため (f1 + f0) . g です。
+     */
+    struct meet_step {
+        self_type& c;
+
+        bool resolve(bin_op_operands& x, node_ptr& r) {
+            if (x.p == c.zero() || x.q == c.zero()) r = c.zero();
+            else if (x.p == c.one() || x.q == c.one()) r = c.one();
+            else {
+                const bool swapped = (x.p->label() != x.q->label()) ?
+                    x.q->label() < x.p->label() :
+                    x.q->index() < x.p->index();
+                if (swapped) std::swap(x.p, x.q);
+                return c.find_cache(c.meet_table, make_bin_op_key(x.p, x.q), r);
+            }
+            return true;
+        }
+
+        size_t expand(bin_op_operands& x, bin_op_operands* sub) const {
+            const node_ptr& f = x.p;
+            const node_ptr& g = x.q;
+            x.v = f->label();
+            const node_ptr f1 = f->then_node(), f0 = f->else_node();
+            const node_ptr f10 = c.apply_union(f1, f0);
+            if (f->label() == g->label()) {
+                const node_ptr g1 = g->then_node(), g0 = g->else_node();
+                sub[0] = bin_op_operands{f1, g1, x.v};
+                sub[1] = bin_op_operands{f10, g0, x.v};
+                sub[2] = bin_op_operands{f0, g1, x.v};
+                return 3;
+            }
+            sub[0] = bin_op_operands{f10, g, x.v};
+            return 1;
+        }
+
+        node_ptr combine(const bin_op_operands& x, const node_ptr* r) {
+            const node_ptr n = (x.p->label() == x.q->label()) ?
+                c.new_var(x.v, r[0], c.apply_union(r[1], r[2])) :
+                r[0];
+            c.meet_table.insert(make_bin_op_key(x.p, x.q), c.store.save(n));
+            return n;
+        }
+    };
+
+    using change_stack_type = apply_stack<change_operands, node_ptr>;
+    using bin_op_stack_type = apply_stack<bin_op_operands, node_ptr, 3>;
+
+    /*!
+     * スレッドごとのエンジンを返します
+     *
+     * 同じスレッドの入れ子の呼び出しはスタックの続きを用いるため、テーブルの間で共有できます。
+     */
+    static change_stack_type& change_stack() {
+        static thread_local change_stack_type s;
+        return s;
+    }
+
+    static bin_op_stack_type& bin_op_stack() {
+        static thread_local bin_op_stack_type s;
+        return s;
+    }
+
+    /*!
+     * スレッドの数が設定されていれば上位の階層を並列に、そうでなければ逐次に演算を適用します
+     */
+    template<class Stack, class Step>
+    const node_ptr run(Stack& (*local)(), Step step, const typename Stack::operands_type& x) {
+        if (pool) return parallel_apply(*pool, local, step, x, spawn_depth);
+        return local().run(step, x);
     }
 
     /*!
@@ -66,9 +477,7 @@ public:
      * @brief コンストラクタ
      */
     basic_combination_cache() :
-            __terminal_false(0), __terminal_true(1),
-            terminal_false(&__terminal_false, null_deleter()),
-            terminal_true(&__terminal_true, null_deleter())
+            gc_ratio(0.5), gc_min_nodes(1 << 16), spawn_depth(0)
     {}
 
     /*! @brief コピーは禁止されています */
@@ -79,27 +488,136 @@ public:
     /*!
      * @brief 0定節点を返します
      */
-    const node_ptr& zero() const {return terminal_false;}
+    const node_ptr& zero() const {return store.zero();}
     /*!
      * @brief 1定節点を返します
      */
-    const node_ptr& one() const {return terminal_true;}
+    const node_ptr& one() const {return store.one();}
+
+    /*!
+     * @brief 使用中のノードの数を返します
+     *
+     * 参照されていないがまだ回収されていないノードも含みます。
+     */
+    size_t size() const {return store.size();}
+
+    /*!
+     * @brief 変数の順序における位置を返します
+     *
+     * 位置が小さいほど根に近い変数です。
+     */
+    label_type level(const label_type& l) const {
+        return store.level(l);
+    }
+
+    /*!
+     * @brief 演算ごとのキャッシュのエントリ数を変更します
+     *
+     * @param log2_size エントリ数の2を底とする対数
+     */
+    void set_cache_size(const size_t log2_size) {
+        for_each_table(resize_table{log2_size});
+    }
+
+    /*!
+     * @brief 演算キャッシュの自動拡張の設定を変更します
+     *
+     * @sa operation_cache::set_auto_resize
+     */
+    void set_cache_auto_resize(const size_t max_log2_size, const double min_hit_ratio = 0.3) {
+        for_each_table(set_table_auto_resize{max_log2_size, min_hit_ratio});
+    }
+
+    /*!
+     * @brief 全ての演算キャッシュの統計情報を合算して返します
+     */
+    operation_cache_statistics cache_statistics() {
+        operation_cache_statistics s;
+        for_each_table(sum_table_statistics{s});
+        return s;
+    }
+
+    /*!
+     * @brief 参照されていないノードを回収します
+     *
+     * インデックスが再利用される場合は演算キャッシュも破棄します。
+     * 演算の途中で呼び出してはいけません。
+     */
+    gc_statistics gc() {
+        gc_statistics s = store.gc();
+        if (s.indices > 0) for_each_table(clear_table{s.cache_entries});
+        return s;
+    }
+
+    /*!
+     * @brief 自動的にガベージコレクションを行う条件を設定します
+     *
+     * @param ratio 解放されたノードの割合がこれを超えると回収します。1 以上なら自動では回収しません
+     * @param min_nodes ノードの数がこれ未満なら回収しません
+     */
+    void set_gc_threshold(const double ratio, const size_t min_nodes = 1 << 16) {
+        gc_ratio = ratio;
+        gc_min_nodes = min_nodes;
+    }
+
+    /*!
+     * @brief 演算に用いるスレッドの数を設定します
+     *
+     * 2 以上を設定すると、集合演算の上位の階層をワークスティーリングで並列に計算します。
+     * 複数のスレッドから同時に操作できるノードを用いる場合のみ利用できます。
+     * 演算の途中で呼び出してはいけません。
+     *
+     * @param n 呼び出し元のスレッドを含めたスレッドの数
+     */
+    void set_threads(const size_t n) {
+        static_assert(concurrent, "set_threads() requires a concurrent node store");
+        pool.reset();
+        if (n <= 1) return;
+        pool.reset(new work_stealing_pool(n));
+        // join と meet は 3 つに分岐するため、二項演算より浅い段で十分なタスクが得られる
+        spawn_depth = 3;
+        for (size_t m = 1; m < n; m <<= 1) spawn_depth++;
+    }
+
+    /*!
+     * @brief 演算に用いるスレッドの数を返します
+     */
+    size_t threads() const {
+        return pool ? pool->size() : 1;
+    }
+
+    /*!
+     * @brief unique table のスロット数を変更します
+     *
+     * 複数のスレッドから同時に操作できるノードを用いる場合のみ利用できます。
+     * 演算の途中で呼び出してはいけません。
+     *
+     * @sa concurrent_arena_node_store::reserve
+     */
+    void reserve(const size_t log2_slots) {
+        store.reserve(log2_slots);
+    }
+
+    /*!
+     * @brief 条件を満たしていればガベージコレクションを行います
+     *
+     * 演算の途中で呼び出してはいけません。
+     *
+     * @return 回収を行えば true
+     */
+    bool gc_if_needed() {
+        const size_t n = store.size();
+        if (n < gc_min_nodes || store.dead_count() <= gc_ratio * n) return false;
+        gc();
+        return true;
+    }
 
     /*!
      * @brief 新しいノードを生成します
      */
     const node_ptr new_var(const label_type& _label, const node_ptr& t, const node_ptr& e) {
         if (t == zero()) return e;
-        // もうすでに存在するなら既存のノードを返す
-        const unique_key_type key = make_unique_key(_label, t, e);
-        const auto it = unique_table.find(key);
-        if (it != unique_table.end() && !it->second.expired()) {
-            return it->second.lock();
-        }
-        // 存在しなければ新しく生成
-        const node_ptr pf(new node_type(igen.get_index(key) + 2, _label, t, e));
-        unique_table[key] = pf; // 登録
-        return pf;
+        return store.make_node(_label, t, e);
     }
 
     /*!
@@ -109,188 +627,87 @@ public:
         return new_var(_label, one(), zero());
     }
 
+    /*!
+     * @brief 特定のアイテムを含まない集合を返します
+     */
     const node_ptr apply_offset(const node_ptr& _root, const label_type& v) {
-        if (_root->label() == v) return _root->else_node();
-        if (_root->label() > v) return _root;
-        const auto key = make_change_key(_root, v);
-        const auto it = offset_table.find(key);
-        if (it != offset_table.end() && !it->second.expired()) {
-            return it->second.lock();
-        }
-        const node_ptr& r = new_var(_root->label(),
-                                   apply_offset(_root->then_node(), v),
-                                   apply_offset(_root->else_node(), v));
-        offset_table[key] = r;
-        return r;
+        return run(&change_stack, change_step<offset_op>{*this}, change_operands{_root, v});
     }
 
+    /*!
+     * @brief 特定のアイテムを含む集合からそのアイテムを取り除いた集合を返します
+     */
     const node_ptr apply_onset(const node_ptr& _root, const label_type& v) {
-        if (_root->label() == v) return _root->then_node();
-        if (_root->label() > v) return zero();
-        const auto key = make_change_key(_root, v);
-        const auto it = onset_table.find(key);
-        if (it != onset_table.end() && !it->second.expired()) {
-            return it->second.lock();
-        }
-        const node_ptr& r = new_var(_root->label(),
-                                   apply_onset(_root->then_node(), v),
-                                   apply_onset(_root->else_node(), v));
-        onset_table[key] = r;
-        return r;
+        return run(&change_stack, change_step<onset_op>{*this}, change_operands{_root, v});
     }
 
     /*!
      * @brief 特定のアイテムの存在を反転させた結果を返します
      */
     const node_ptr apply_change(const node_ptr& _root, const label_type& v) {
-        if (_root->label() == v) return new_var(v, _root->else_node(), _root->then_node());
-        if (_root->label() > v) return new_var(v, _root, zero());
-        const auto key = make_change_key(_root, v);
-        const auto it = change_table.find(key);
-        if (it != change_table.end() && !it->second.expired()) {
-            return it->second.lock();
-        }
-        const node_ptr& r = new_var(_root->label(),
-                                   apply_change(_root->then_node(), v),
-                                   apply_change(_root->else_node(), v));
-        change_table[key] = r;
-        return r;
+        return run(&change_stack, change_step<change_op>{*this}, change_operands{_root, v});
     }
 
     /*!
      * @brief 和集合を返します
      */
     const node_ptr apply_union(const node_ptr& p, const node_ptr& q) {
-        if (p == zero()) return q;
-        if (q == zero() || p == q) return p;
-        const auto key = make_bin_op_key(p, q);
-        const auto it = union_table.find(key);
-        if (it != union_table.end() && !it->second.expired()) {
-            return it->second.lock();
-        }
-
-        node_ptr r;
-        if (p->label() < q->label()) {
-            r = new_var(p->label(),
-                        p->then_node(),
-                        apply_union(p->else_node(), q));
-        }
-        else if (p->label() > q->label()) {
-            r = new_var(q->label(),
-                        q->then_node(),
-                        apply_union(p, q->else_node()));
-        }
-        else {
-            r = new_var(p->label(),
-                        apply_union(p->then_node(), q->then_node()) ,
-                        apply_union(p->else_node(), q->else_node()));
-        }
-
-        union_table[key] = r;
-        return r;
+        return run(&bin_op_stack, union_step{*this}, bin_op_operands{p, q, label_type()});
     }
 
     /*!
      * @brief 積集合を返します
      */
     const node_ptr apply_intersection(const node_ptr& p, const node_ptr& q) {
-        if (p == zero() || q == zero()) return zero();
-        if (p == q) return p;
-        const auto key = make_bin_op_key(p, q);
-        const auto it = intersection_table.find(key);
-        if (it != intersection_table.end() && !it->second.expired()) {
-            return it->second.lock();
-        }
-
-        node_ptr r;
-        if (p->label() < q->label()) {
-            r = apply_intersection(p->else_node(), q);
-        }
-        else if (p->label() > q->label()) {
-            r = apply_intersection(q->else_node(), p);
-        }
-        else {
-            r = new_var(p->label(),
-                        apply_intersection(p->then_node(), q->then_node()),
-                        apply_intersection(p->else_node(), q->else_node()));
-        }
+        return run(&bin_op_stack, intersection_step{*this}, bin_op_operands{p, q, label_type()});
+    }
 
-        intersection_table[key] = r;
-        return r;
+    /*!
+     * @brief 差集合を返します
+     */
+    const node_ptr apply_subtract(const node_ptr& p, const node_ptr& q) {
+        return run(&bin_op_stack, subtract_step{*this}, bin_op_operands{p, q, label_type()});
     }
 
-    const node_ptr apply_join(const node_ptr& p, const node_ptr& q) {
-        if (p == zero() || q == zero()) return zero();
-        if (p == one()) return q;
-        if (q == one()) return p;
-
-        auto m = std::minmax(p, q, [](const node_ptr& a, const node_ptr& b) {
-            return a->label() < b->label();
-        });
-        const node_ptr& f = std::get<0>(m), g = std::get<1>(m);
-
-        const auto key = make_bin_op_key(f, g);
-        const auto it = join_table.find(key);
-        if (it != join_table.end() && !it->second.expired()) {
-            return it->second.lock();
-        }
+    /*!
+     * @brief 弱除算の商を返します
+     *
+     * 商は h * q が p に含まれるような最大の集合 h のうち、q のアイテムを含まないものです。
+     * q が空集合の場合は std::invalid_argument を送出します。
+     */
+    const node_ptr apply_divide(const node_ptr& p, const node_ptr& q) {
+        if (q == zero()) throw std::invalid_argument("boloq: division by the empty family");
+        return run(&bin_op_stack, divide_step{*this}, bin_op_operands{p, q, label_type()});
+    }
 
-        const auto f1 = apply_onset(f, f->label());
-        const auto f0 = apply_offset(f, f->label());
+    /*!
+     * @brief 弱除算の剰余 p - (p / q) * q を返します
+     */
+    const node_ptr apply_remainder(const node_ptr& p, const node_ptr& q) {
         node_ptr r;
-        if (f->label() == g->label()) {
-            const auto g1 = apply_onset(g, f->label());
-            const auto g0 = apply_offset(g, f->label());
-            r = apply_union(apply_change(
-                    // (f1 * g1) + (f1 * g0) + (f0 * g1)
-                    apply_union(apply_union(apply_join(f1, g1), apply_join(f1, g0)), apply_join(f0, g1)),
-                f->label()), apply_join(f0, g0));
-        }
-        else {
-            r = apply_union(apply_change(apply_join(f1, g), f->label()), apply_join(f0, g));
-        }
-
-        join_table[key] = r;
+        if (find_cache(remainder_table, make_bin_op_key(p, q), r)) return r;
+        r = apply_subtract(p, apply_join(apply_divide(p, q), q));
+        remainder_table.insert(make_bin_op_key(p, q), store.save(r));
         return r;
     }
 
-    const node_ptr apply_meet(const node_ptr& p, const node_ptr& q) {
-        if (p == zero() || q == zero()) return zero();
-        if (p == one() || q == one()) return one();
-
-        auto m = std::minmax(p, q, [](const node_ptr& a, const node_ptr& b) {
-            return (a->label() != b->label()) ?
-                a->label() < b->label() :
-                a->index() < b->index();
-        });
-        const node_ptr& f = std::get<0>(m), g = std::get<1>(m);
-
-        const auto key = make_bin_op_key(f, g);
-        const auto it = meet_table.find(key);
-        if (it != meet_table.end() && !it->second.expired()) {
-            return it->second.lock();
-        }
-
-        const auto f1 = apply_onset(f, f->label());
-        const auto f0 = apply_offset(f, f->label());
-        node_ptr r;
-        if (f->label() == g->label()) {
-            const auto g1 = apply_onset(g, f->label());
-            const auto g0 = apply_offset(g, f->label());
-            r = apply_union(apply_union(apply_union(
-                    apply_change(apply_meet(f1, g1), f->label()),
-                    apply_meet(f0, g0)),
-                    apply_meet(f1, g0)),
-                    apply_meet(f0, g1));
-        }
-        else {
-            r = apply_union(apply_meet(f0, g), apply_meet(f1, g));
-        }
+    /*!
+     * @brief 2つの集合の要素同士の和集合を全て集めた集合を返します
+     */
+    const node_ptr apply_join(const node_ptr& p, const node_ptr& q) {
+        return run(&bin_op_stack, join_step{*this}, bin_op_operands{p, q, label_type()});
+    }
 
-        meet_table[key] = r;
-        return r;
+    /*!
+     * @brief 2つの集合の要素同士の積集合を全て集めた集合を返します
+     */
+    const node_ptr apply_meet(const node_ptr& p, const node_ptr& q) {
+        return run(&bin_op_stack, meet_step{*this}, bin_op_operands{p, q, label_type()});
     }
 
 };
 
+template<class N>
+constexpr bool basic_combination_cache<N>::concurrent;
+
 }
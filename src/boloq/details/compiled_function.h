@@ -0,0 +1,163 @@
+#pragma once
+
+namespace boloq {
+
+/*!
+ * @brief 論理関数を連続した分岐表に固めたものです
+ *
+ * 根から幅優先に並べた {変数, 0枝, 1枝} の表を持ち、
+ * 変数の値で次の行を選ぶことを定節点に至るまで繰り返して評価します。
+ * 枝は表の位置で参照し、0 と 1 は定節点を表します。
+ * 変数は論理関数に現れるものだけをラベルの昇順に詰めた入力の位置で参照し、
+ * i 番目の入力は labels() の i 番目の変数に対応します。
+ *
+ * 表は生成したときの論理関数の写しであり、変更されることはありません。
+ * 元の論理関数やテーブルが破棄されたり、変数の順序が変わったりしても使えます。
+ *
+ * @tparam T 論理関数の型
+ */
+template<class T>
+class compiled_function {
+public:
+    /*! @brief ラベルの型 */
+    using label_type = typename T::label_type;
+
+    /*!
+     * @brief 分岐表の各行です
+     */
+    struct branch {
+        /*! @brief 変数の入力の位置 */
+        uint32_t input;
+        /*! @brief 変数の値を添字とする子の位置 */
+        uint32_t next[2];
+    };
+
+private:
+    using node_ptr = typename T::node_ptr;
+
+    std::vector<branch> branches;
+    uint32_t root;
+    std::vector<label_type> _labels;
+
+    /*!
+     * 幅優先に辿って表を作ります
+     */
+    struct builder {
+        using result_type = void;
+        compiled_function& c;
+
+        void operator()(const node_ptr& n) const {
+            if (n->is_terminal()) {
+                c.root = n->index() ? 1 : 0;
+                return;
+            }
+            node_scratch<uint32_t> pos;
+            pos.reset();
+            std::vector<node_ptr> queue;
+            const auto position = [&](const node_ptr& m) -> uint32_t {
+                if (m->is_terminal()) return m->index() ? 1 : 0;
+                const size_t i = static_cast<size_t>(m->index());
+                if (!pos.contains(i)) {
+                    if (queue.size() + 2 > std::numeric_limits<uint32_t>::max()) {
+                        throw std::length_error("boloq: function too large to compile");
+                    }
+                    pos.set(i, static_cast<uint32_t>(queue.size() + 2));
+                    queue.push_back(m);
+                }
+                return pos.get(i);
+            };
+            c.root = position(n);
+            // 定節点の分の 2 行を先頭に置く
+            c.branches.resize(2, branch{0, {0, 0}});
+            for (size_t k = 0; k < queue.size(); k++) {
+                const node_ptr m = queue[k];
+                const uint32_t lo = position(m->else_node());
+                const uint32_t hi = position(m->then_node());
+                c.branches.push_back(branch{0, {lo, hi}});
+                c._labels.push_back(m->label());
+            }
+            // 行ごとのラベルを入力の位置に置き換える
+            const std::vector<label_type> rows(c._labels);
+            std::sort(c._labels.begin(), c._labels.end());
+            c._labels.erase(std::unique(c._labels.begin(), c._labels.end()), c._labels.end());
+            for (size_t k = 0; k < rows.size(); k++) {
+                const auto it = std::lower_bound(c._labels.begin(), c._labels.end(), rows[k]);
+                c.branches[k + 2].input = static_cast<uint32_t>(it - c._labels.begin());
+            }
+            c.branches.shrink_to_fit();
+            c._labels.shrink_to_fit();
+        }
+    };
+
+public:
+
+    /*!
+     * @brief 論理関数から分岐表を作ります
+     */
+    explicit compiled_function(const T& f) : root(0) {
+        f.accept(builder{*this});
+    }
+
+    /*!
+     * @brief 入力として必要な変数の数を返します
+     *
+     * 論理関数に現れる変数の数です。
+     */
+    size_t input_count() const {return _labels.size();}
+
+    /*!
+     * @brief 各入力に対応する変数のラベルを、入力の順に返します
+     */
+    const std::vector<label_type>& labels() const {return _labels;}
+
+    /*!
+     * @brief 定節点を除いた分岐の数を返します
+     */
+    size_t size() const {return branches.empty() ? 0 : branches.size() - 2;}
+
+    /*!
+     * @brief 分岐表を返します
+     *
+     * 先頭の 2 行は定節点を表し、根は root_index() の行です。
+     */
+    const std::vector<branch>& table() const {return branches;}
+
+    /*!
+     * @brief 根の位置を返します
+     */
+    uint32_t root_index() const {return root;}
+
+    /*!
+     * @brief 論理関数を評価します
+     *
+     * @param inputs labels() の順に並べた変数の値。input_count() 個の要素が必要です
+     */
+    bool evaluate(const bool* inputs) const {
+        uint32_t i = root;
+        while (i > 1) {
+            const branch& b = branches[i];
+            i = b.next[inputs[b.input] ? 1 : 0];
+        }
+        return i != 0;
+    }
+
+    /*!
+     * @brief 論理関数を評価します
+     *
+     * @param inputs labels() の順に並べた変数の値
+     */
+    template<size_t N>
+    bool evaluate(const std::bitset<N>& inputs) const {
+        if (N < input_count()) {
+            throw std::invalid_argument("boloq: input does not cover all variables");
+        }
+        uint32_t i = root;
+        while (i > 1) {
+            const branch& b = branches[i];
+            i = b.next[inputs[b.input]];
+        }
+        return i != 0;
+    }
+};
+
+}
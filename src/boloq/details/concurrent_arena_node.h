@@ -0,0 +1,345 @@
+#pragma once
+
+namespace boloq {
+
+template<class N>
+class concurrent_arena_node_store;
+
+/*!
+ * @brief 複数のスレッドから同時に生成されるアリーナ上のノードです
+ *
+ * 内容は生成時に一度だけ書き込まれ、その後は変更されません。
+ * 参照カウントを持たないため、1 ノードあたり 12 バイトになります。
+ */
+template<class LT, class IT, bool C = false>
+struct basic_concurrent_arena_node {
+    /*! @brief インデックスを表す型 */
+    using index_type = IT;
+    /*! @brief ラベルを表す型 */
+    using label_type = LT;
+    /*! このクラスを格納するテーブルの型 */
+    using store_type = concurrent_arena_node_store<basic_concurrent_arena_node<LT, IT, C>>;
+    /*! このクラスのハンドルを表す型 */
+    using node_ptr = arena_node_ptr<basic_concurrent_arena_node<LT, IT, C>>;
+    /*! 論理関数や組み合わせ集合が保持するハンドルを表す型 */
+    using root_ptr = arena_root_ptr<basic_concurrent_arena_node<LT, IT, C>>;
+
+    /*! @brief 否定枝を用いるかどうか */
+    static constexpr bool complement_edges = C;
+
+    /*! @brief ノードのラベル */
+    label_type label;
+    /*! @brief 1枝側のノードのハンドル */
+    index_type then_id;
+    /*! @brief 0枝側のノードのハンドル */
+    index_type else_id;
+};
+
+/*!
+ * @brief 複数のスレッドから同時にノードを生成できるアリーナです
+ *
+ * ノードの番号は atomic なカウンタから割り当て、ページは必要になったときに CAS で確保します。
+ * unique table は大きさが固定されたオープンアドレス法のハッシュテーブルで、
+ * 各スロットにはノードの番号だけを格納し、空のスロットへの CAS で登録します。
+ * 同じノードを複数のスレッドが同時に生成した場合は、CAS に負けた方の番号は使われません。
+ *
+ * ノードは回収されず、テーブルが破棄されるまで生存します。
+ * そのため gc() は何も行わず、参照カウントの操作も行いません。
+ */
+template<class N>
+class concurrent_arena_node_store {
+public:
+    /*! @brief このクラスが扱うノードの型 */
+    using node_type = N;
+    /*! @brief このクラスが扱うノードのハンドル型 */
+    using node_ptr = typename node_type::node_ptr;
+    /*! @brief 演算キャッシュに格納される型 */
+    using cache_ptr = typename node_type::index_type;
+
+    /*! @brief 否定枝を用いるかどうか */
+    static constexpr bool complement_edges = node_type::complement_edges;
+    /*! @brief 複数のスレッドから同時に操作できるかどうか */
+    static constexpr bool concurrent = true;
+    /*! @brief 変数の順序を変更できるかどうか */
+    static constexpr bool reorderable = false;
+
+private:
+    using index_type = typename node_type::index_type;
+    using label_type = typename node_type::label_type;
+
+    static constexpr unsigned int page_bits = 16;
+    static constexpr index_type page_mask = (index_type(1) << page_bits) - 1;
+
+    /*! 定節点でない最初のノードの番号 */
+    static constexpr index_type first_id = complement_edges ? 1 : 2;
+
+    std::unique_ptr<std::atomic<node_type*>[]> pages;
+    size_t page_count;
+    std::atomic<index_type> next_id;
+
+    std::unique_ptr<std::atomic<index_type>[]> slots;
+    size_t slot_mask;
+    std::atomic<size_t> _size;
+
+    const node_ptr terminal_false, terminal_true;
+
+    static constexpr index_type id_of(const index_type& h) {
+        return complement_edges ? h >> 1 : h;
+    }
+
+    static constexpr index_type handle_of(const index_type& i, const bool negated) {
+        return complement_edges ? ((i << 1) | (negated ? 0 : 1)) : i;
+    }
+
+    static constexpr index_type flip_of(const index_type& h) {
+        return complement_edges ? (~h & 1) : 0;
+    }
+
+    static size_t hash(const label_type& l, const index_type& t, const index_type& e) {
+        uint64_t h = uint64_t(t) * 0x9e3779b97f4a7c15ULL ^ uint64_t(e);
+        h ^= uint64_t(l) * 0xc2b2ae3d27d4eb4fULL;
+        h ^= h >> 32;
+        h *= 0xd6e8feb86659fd93ULL;
+        h ^= h >> 32;
+        return static_cast<size_t>(h);
+    }
+
+    node_type& at(const index_type& i) const {
+        return pages[i >> page_bits].load(std::memory_order_acquire)[i & page_mask];
+    }
+
+    /*!
+     * 新しいノードの領域を確保します
+     */
+    index_type allocate() {
+        const index_type i = next_id.fetch_add(1, std::memory_order_relaxed);
+        const size_t p = i >> page_bits;
+        if (i == id_of(std::numeric_limits<index_type>::max()) || p >= page_count) {
+            throw std::length_error("boloq: concurrent_arena_node_store is full");
+        }
+        if (pages[p].load(std::memory_order_acquire) == nullptr) {
+            node_type* page = new node_type[page_mask + 1];
+            node_type* expected = nullptr;
+            if (!pages[p].compare_exchange_strong(expected, page, std::memory_order_acq_rel)) {
+                delete[] page;
+            }
+        }
+        return i;
+    }
+
+    /*!
+     * 番号 i のノードを unique table に登録します
+     *
+     * テーブルへの登録は他のスレッドと競合しない場合にのみ用います。
+     */
+    void insert_unique(const index_type& i) {
+        const node_type& n = at(i);
+        size_t k = hash(n.label, n.then_id, n.else_id) & slot_mask;
+        while (slots[k].load(std::memory_order_relaxed) != 0) k = (k + 1) & slot_mask;
+        slots[k].store(i, std::memory_order_relaxed);
+    }
+
+public:
+
+    /*!
+     * @brief コンストラクタ
+     *
+     * @param log2_slots unique table のスロット数の2を底とする対数
+     */
+    explicit concurrent_arena_node_store(const size_t log2_slots = 20) :
+            page_count((size_t(id_of(std::numeric_limits<index_type>::max())) >> page_bits) + 1),
+            next_id(0),
+            _size(0),
+            terminal_false(this, 0),
+            terminal_true(this, 1)
+    {
+        pages.reset(new std::atomic<node_type*>[page_count]);
+        for (size_t p = 0; p < page_count; p++) pages[p].store(nullptr, std::memory_order_relaxed);
+        slot_mask = (size_t(1) << log2_slots) - 1;
+        slots.reset(new std::atomic<index_type>[slot_mask + 1]);
+        for (size_t k = 0; k <= slot_mask; k++) slots[k].store(0, std::memory_order_relaxed);
+        for (index_type i = 0; i < first_id; i++) {
+            node_type& n = at(allocate());
+            n.label = std::numeric_limits<label_type>::max();
+            n.then_id = n.else_id = handle_of(i, false);
+        }
+    }
+
+    ~concurrent_arena_node_store() {
+        for (size_t p = 0; p < page_count; p++) delete[] pages[p].load(std::memory_order_relaxed);
+    }
+
+    /*! @brief コピーは禁止されています */
+    concurrent_arena_node_store(const concurrent_arena_node_store&) = delete;
+    /*! @brief 代入は禁止されています */
+    concurrent_arena_node_store& operator=(const concurrent_arena_node_store&) = delete;
+
+    /*!
+     * @brief 変数の順序における位置を返します
+     *
+     * 変数の順序は変更できないため、ラベルをそのまま返します。
+     */
+    const label_type& level(const label_type& l) const {return l;}
+
+    /*!
+     * @brief 0定節点を返します
+     */
+    const node_ptr& zero() const {return terminal_false;}
+    /*!
+     * @brief 1定節点を返します
+     */
+    const node_ptr& one() const {return terminal_true;}
+
+    /*!
+     * @brief ハンドルが指すノードのラベルを返します
+     */
+    const label_type& label(const index_type& h) const {
+        return at(id_of(h)).label;
+    }
+
+    /*!
+     * @brief ハンドルが表す関数の1枝側のハンドルを返します
+     */
+    index_type then_index(const index_type& h) const {
+        return at(id_of(h)).then_id ^ flip_of(h);
+    }
+
+    /*!
+     * @brief ハンドルが表す関数の0枝側のハンドルを返します
+     */
+    index_type else_index(const index_type& h) const {
+        return at(id_of(h)).else_id ^ flip_of(h);
+    }
+
+    /*!
+     * @brief 否定を表すハンドルを返します
+     *
+     * 否定枝を用いる場合のみ利用できます。
+     */
+    const node_ptr negate(const node_ptr& n) const {
+        static_assert(complement_edges, "negate() requires complement edges");
+        return node_ptr(this, n.index() ^ 1);
+    }
+
+    /*!
+     * @brief unique table のスロット数を変更します
+     *
+     * 他のスレッドが演算を行っている間に呼び出してはいけません。
+     *
+     * @param log2_slots スロット数の2を底とする対数
+     */
+    void reserve(const size_t log2_slots) {
+        const size_t n = size_t(1) << log2_slots;
+        if (n <= slot_mask + 1 || n < _size.load() * 10 / 9) return;
+        slot_mask = n - 1;
+        slots.reset(new std::atomic<index_type>[n]);
+        for (size_t k = 0; k < n; k++) slots[k].store(0, std::memory_order_relaxed);
+        const index_type last = next_id.load();
+        for (index_type i = first_id; i < last; i++) {
+            if (at(i).label != std::numeric_limits<label_type>::max()) insert_unique(i);
+        }
+    }
+
+    /*!
+     * @brief 使用中のノードの数を返します
+     */
+    size_t size() const {return _size.load(std::memory_order_relaxed);}
+
+    /*!
+     * @brief 参照されていないノードの数を返します
+     *
+     * ノードは回収されないため常に 0 です。
+     */
+    size_t dead_count() const {return 0;}
+
+    /*!
+     * @brief ノードは回収されないため何も行いません
+     */
+    gc_statistics gc() {return gc_statistics();}
+
+    /*!
+     * @brief ノード (l, t, e) を返します
+     *
+     * 複数のスレッドから同時に呼び出すことができます。
+     * 既に存在する場合は既存のノードを返します。
+     * 否定枝を用いる場合は、t が否定でなくなるように正規化します。
+     */
+    const node_ptr make_node(const label_type& l, const node_ptr& t, const node_ptr& e) {
+        const index_type flip = flip_of(t.index());
+        const index_type ti = t.index() ^ flip, ei = e.index() ^ flip;
+        index_type fresh = 0;
+        size_t k = hash(l, ti, ei) & slot_mask;
+        for (size_t probes = 0; probes <= slot_mask; probes++, k = (k + 1) & slot_mask) {
+            index_type i = slots[k].load(std::memory_order_acquire);
+            if (i == 0) {
+                if (_size.load(std::memory_order_relaxed) * 10 >= slot_mask * 9) break;
+                if (fresh == 0) {
+                    fresh = allocate();
+                    node_type& n = at(fresh);
+                    n.label = l;
+                    n.then_id = ti;
+                    n.else_id = ei;
+                }
+                if (slots[k].compare_exchange_strong(i, fresh, std::memory_order_acq_rel)) {
+                    _size.fetch_add(1, std::memory_order_relaxed);
+                    return node_ptr(this, handle_of(fresh, flip != 0));
+                }
+                // 他のスレッドが先に登録したスロットを調べる
+            }
+            const node_type& n = at(i);
+            if (n.label == l && n.then_id == ti && n.else_id == ei) {
+                // 確保した番号は使われずに残る
+                if (fresh != 0) at(fresh).label = std::numeric_limits<label_type>::max();
+                return node_ptr(this, handle_of(i, flip != 0));
+            }
+        }
+        // CAS に負けた後で表が埋まった場合も、確保した番号を reserve() で登録しないようにする
+        if (fresh != 0) at(fresh).label = std::numeric_limits<label_type>::max();
+        throw std::length_error("boloq: concurrent unique table is full");
+    }
+
+    /*!
+     * @brief 参照カウントを持たないため何も行いません
+     */
+    void acquire(const index_type&) const {}
+
+    /*!
+     * @brief 参照カウントを持たないため何も行いません
+     */
+    void release(const index_type&) const {}
+
+    /*!
+     * @brief 演算キャッシュからノードを取り出します
+     */
+    bool load(const cache_ptr& c, node_ptr& n) const {
+        n = node_ptr(this, c);
+        return true;
+    }
+
+    /*!
+     * @brief 演算キャッシュに格納する値を生成します
+     */
+    cache_ptr save(const node_ptr& n) const {
+        return n.index();
+    }
+};
+
+template<class N>
+constexpr unsigned int concurrent_arena_node_store<N>::page_bits;
+
+template<class N>
+constexpr typename concurrent_arena_node_store<N>::index_type concurrent_arena_node_store<N>::page_mask;
+
+template<class N>
+constexpr typename concurrent_arena_node_store<N>::index_type concurrent_arena_node_store<N>::first_id;
+
+template<class N>
+constexpr bool concurrent_arena_node_store<N>::complement_edges;
+
+template<class N>
+constexpr bool concurrent_arena_node_store<N>::concurrent;
+
+template<class N>
+constexpr bool concurrent_arena_node_store<N>::reorderable;
+
+}
@@ -0,0 +1,163 @@
+#pragma once
+
+namespace boloq {
+
+namespace details {
+
+/*! \internal
+ * tuple の各要素を 64bit の語に詰め替えます
+ */
+template<class Tuple, size_t Index = std::tuple_size<Tuple>::value>
+struct tuple_words {
+    static void pack(const Tuple& t, uint64_t* w) {
+        tuple_words<Tuple, Index - 1>::pack(t, w);
+        w[Index - 1] = static_cast<uint64_t>(std::get<Index - 1>(t));
+    }
+    static void unpack(const uint64_t* w, Tuple& t) {
+        tuple_words<Tuple, Index - 1>::unpack(w, t);
+        using element_type = typename std::tuple_element<Index - 1, Tuple>::type;
+        std::get<Index - 1>(t) = static_cast<element_type>(w[Index - 1]);
+    }
+};
+
+/*! \internal */
+template<class Tuple>
+struct tuple_words<Tuple, 0> {
+    static void pack(const Tuple&, uint64_t*) {}
+    static void unpack(const uint64_t*, Tuple&) {}
+};
+
+}
+
+/*!
+ * @brief 複数のスレッドから同時に操作できる演算キャッシュです
+ *
+ * キーは整数の tuple、値は整数でなければなりません。
+ * 各エントリは seqlock で保護され、読み出しはロックを取りません。
+ * 書き込みが競合した場合は登録を諦めるため、結果が失われることがあります。
+ *
+ * スレッド間でカウンタを共有すると性能が落ちるため、統計情報は capacity のみを返します。
+ * 自動拡張は行いません。
+ */
+template<class K, class V>
+class concurrent_operation_cache {
+public:
+    /*! @brief キーの型 */
+    using key_type = typename std::remove_const<K>::type;
+    /*! @brief 値の型 */
+    using value_type = V;
+
+private:
+    static constexpr size_t key_words = std::tuple_size<key_type>::value;
+
+    struct entry {
+        std::atomic<uint32_t> seq;
+        std::atomic<uint64_t> words[key_words + 1];
+    };
+
+    std::unique_ptr<entry[]> entries;
+    size_t mask;
+
+    std::hash<const key_type> hash_fn;
+
+public:
+
+    /*!
+     * @brief コンストラクタ
+     *
+     * @param log2_size エントリ数の2を底とする対数
+     */
+    explicit concurrent_operation_cache(const size_t log2_size = 16) : mask(0) {
+        resize(log2_size);
+    }
+
+    /*!
+     * @brief キーに対応する値を検索します
+     *
+     * @return 見つかれば true
+     */
+    bool find(const key_type& key, value_type& value) const {
+        const entry& e = entries[hash_fn(key) & mask];
+        const uint32_t s = e.seq.load(std::memory_order_acquire);
+        // 0 は未使用、奇数は書き込み中
+        if (s == 0 || (s & 1)) return false;
+        uint64_t w[key_words + 1];
+        for (size_t i = 0; i <= key_words; i++) w[i] = e.words[i].load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (e.seq.load(std::memory_order_relaxed) != s) return false;
+
+        uint64_t k[key_words];
+        details::tuple_words<key_type>::pack(key, k);
+        for (size_t i = 0; i < key_words; i++) {
+            if (k[i] != w[i]) return false;
+        }
+        value = static_cast<value_type>(w[key_words]);
+        return true;
+    }
+
+    /*!
+     * @brief 値を登録します
+     *
+     * 他のスレッドが同じエントリに書き込んでいる場合は何もしません。
+     */
+    void insert(const key_type& key, const value_type& value) {
+        entry& e = entries[hash_fn(key) & mask];
+        uint32_t s = e.seq.load(std::memory_order_relaxed);
+        if ((s & 1) || !e.seq.compare_exchange_strong(s, s + 1, std::memory_order_acquire)) return;
+        std::atomic_thread_fence(std::memory_order_release);
+        uint64_t w[key_words + 1];
+        details::tuple_words<key_type>::pack(key, w);
+        w[key_words] = static_cast<uint64_t>(value);
+        for (size_t i = 0; i <= key_words; i++) e.words[i].store(w[i], std::memory_order_relaxed);
+        e.seq.store(s + 2, std::memory_order_release);
+    }
+
+    /*!
+     * @brief 全てのエントリを削除します
+     *
+     * 他のスレッドが操作している間に呼び出してはいけません。
+     *
+     * @return 削除した有効なエントリの数
+     */
+    size_t clear() {
+        size_t n = 0;
+        for (size_t i = 0; i <= mask; i++) {
+            if (entries[i].seq.load(std::memory_order_relaxed) != 0) ++n;
+            entries[i].seq.store(0, std::memory_order_relaxed);
+        }
+        return n;
+    }
+
+    /*!
+     * @brief エントリ数を変更します
+     *
+     * 保持しているエントリは破棄されます。
+     * 他のスレッドが操作している間に呼び出してはいけません。
+     *
+     * @param log2_size エントリ数の2を底とする対数
+     */
+    void resize(const size_t log2_size) {
+        mask = (size_t(1) << log2_size) - 1;
+        entries.reset(new entry[mask + 1]);
+        for (size_t i = 0; i <= mask; i++) entries[i].seq.store(0, std::memory_order_relaxed);
+    }
+
+    /*!
+     * @brief 自動拡張は行わないため何もしません
+     */
+    void set_auto_resize(const size_t, const double) {}
+
+    /*!
+     * @brief 統計情報を返します
+     */
+    operation_cache_statistics statistics() const {
+        operation_cache_statistics s;
+        s.capacity = mask + 1;
+        return s;
+    }
+};
+
+template<class K, class V>
+constexpr size_t concurrent_operation_cache<K, V>::key_words;
+
+}
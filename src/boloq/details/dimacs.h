@@ -0,0 +1,451 @@
+#pragma once
+
+namespace boloq {
+
+/*!
+ * @brief 連言標準形の論理式です
+ */
+struct cnf_formula {
+    /*! @brief 変数の数 */
+    size_t variables;
+    /*! @brief 節の一覧。各リテラルは DIMACS と同じく 1 から始まる符号付きの変数の番号です */
+    std::vector<std::vector<int>> clauses;
+
+    cnf_formula() : variables(0) {}
+};
+
+/*!
+ * @brief DIMACS 形式の CNF を節ごとに読み込みます
+ *
+ * c で始まるコメント行を読み飛ばし、p cnf 行に続く節を 0 で区切って読みます。
+ * % の行があればそこで終わります。
+ * 節は複数の行にまたがっても構いません。
+ * 読んだ節は保持しないため、cnf_builder::build に渡せば節の一覧をメモリに置かずに変換できます。
+ * 形式が正しくない場合は std::runtime_error を送出します。
+ */
+class dimacs_reader {
+private:
+    std::istream& is;
+    size_t _variables, _clauses;
+    bool done;
+    std::vector<int> clause;
+
+    static void fail(const char* what) {
+        throw std::runtime_error(std::string("boloq: ") + what);
+    }
+
+public:
+
+    /*!
+     * @brief p cnf 行までを読みます
+     */
+    explicit dimacs_reader(std::istream& i) : is(i), _variables(0), _clauses(0), done(false) {
+        std::string token;
+        while (is >> token) {
+            if (token[0] == 'c') {
+                std::getline(is, token);
+                continue;
+            }
+            if (token != "p") fail("DIMACS clause before header");
+            std::string format;
+            if (!(is >> format >> _variables >> _clauses) || format != "cnf") {
+                fail("invalid DIMACS header");
+            }
+            return;
+        }
+        fail("missing DIMACS header");
+    }
+
+    /*!
+     * @brief 変数の数を返します
+     */
+    size_t variables() const {return _variables;}
+
+    /*!
+     * @brief p cnf 行で宣言された節の数を返します
+     */
+    size_t declared_clauses() const {return _clauses;}
+
+    /*!
+     * @brief 次の節を読みます
+     *
+     * 各リテラルは DIMACS と同じく 1 から始まる符号付きの変数の番号です。
+     * 返した参照は、次に呼び出すまで有効です。
+     *
+     * @return 次の節。節が残っていなければ nullptr
+     */
+    const std::vector<int>* next() {
+        clause.clear();
+        std::string token;
+        while (!done && is >> token) {
+            if (token[0] == 'c') {
+                std::getline(is, token);
+                continue;
+            }
+            // SATLIB の形式では % 以降は節ではない
+            if (token[0] == '%') break;
+            if (token == "p") fail("invalid DIMACS header");
+            size_t used = 0;
+            long literal = 0;
+            try {
+                literal = std::stol(token, &used);
+            }
+            catch (const std::exception&) {
+                fail("invalid DIMACS literal");
+            }
+            if (used != token.size()) fail("invalid DIMACS literal");
+            if (literal == 0) return &clause;
+            if (static_cast<size_t>(std::labs(literal)) > _variables) fail("DIMACS variable out of range");
+            clause.push_back(static_cast<int>(literal));
+        }
+        done = true;
+        return clause.empty() ? nullptr : &clause;
+    }
+};
+
+/*!
+ * @brief DIMACS 形式の CNF を全て読み込みます
+ *
+ * 全ての節をメモリに保持します。cnf_edges で変数の順序を求めるなど、
+ * 節の一覧が必要な場合に用います。変換するだけであれば、
+ * dimacs_reader を cnf_builder::build に渡す方が節の一覧の分だけ少ないメモリで済みます。
+ *
+ * @sa dimacs_reader
+ */
+inline cnf_formula read_dimacs(std::istream& is) {
+    dimacs_reader reader(is);
+    cnf_formula cnf;
+    cnf.variables = reader.variables();
+    while (const std::vector<int>* c = reader.next()) cnf.clauses.push_back(*c);
+    return cnf;
+}
+
+/*!
+ * @brief 節を変数の番号 (0 から始まる) の集合として返します
+ *
+ * force_order や min_span_order に渡して変数の順序を求めるのに用います。
+ */
+inline std::vector<std::vector<size_t>> cnf_edges(const cnf_formula& cnf) {
+    std::vector<std::vector<size_t>> edges;
+    for (const auto& c : cnf.clauses) {
+        std::vector<size_t> e;
+        for (const int l : c) e.push_back(static_cast<size_t>(std::abs(l)) - 1);
+        std::sort(e.begin(), e.end());
+        e.erase(std::unique(e.begin(), e.end()), e.end());
+        edges.push_back(e);
+    }
+    return edges;
+}
+
+/*!
+ * @brief 節の論理積を求める順序の方針です
+ */
+enum class conjoin_schedule {
+    /*! @brief 先頭から順に論理積を取ります */
+    linear,
+    /*! @brief 隣り合う2つずつの論理積を取ることを繰り返します */
+    balanced,
+    /*! @brief 変数ごとのバケットに分け、根から遠い変数のバケットから処理します */
+    bucket,
+    /*! @brief ノードの最も少ない2つの論理積を取ることを繰り返します */
+    smallest_first
+};
+
+/*!
+ * @brief CNF から論理関数を生成した結果です
+ */
+struct cnf_statistics {
+    /*! @brief 生成中のテーブルのノードの数の最大値 */
+    size_t peak_nodes;
+    /*! @brief 論理積を取った回数 */
+    size_t conjunctions;
+
+    cnf_statistics() : peak_nodes(0), conjunctions(0) {}
+};
+
+/*!
+ * @brief CNF を論理関数に変換します
+ *
+ * 各節を論理関数にしたのち、conjoin_schedule に従って論理積を取ります。
+ * 存在量化する変数を指定した場合、bucket ではその変数を含む節を全て結合した時点で
+ * and_exists により量化し、以降の論理積を小さく保ちます。
+ * それ以外の方針では最後にまとめて量化します。
+ *
+ * 節は読んだ順に論理関数へ変換し、節そのものは保持しません。
+ * linear と balanced は節の論理関数も読みながら論理積にまとめるため、
+ * dimacs_reader から変換すれば節の数に比例するものを何も保持しません。
+ * bucket と smallest_first は順序を決めるために全ての節の論理関数を保持します。
+ *
+ * @tparam F 論理関数の型
+ */
+template<class F>
+class cnf_builder {
+public:
+    /*! @brief テーブルの型 */
+    using table_type = typename F::table_type;
+    /*! @brief ラベルの型 */
+    using label_type = typename F::label_type;
+
+private:
+    /*!
+     * 論理関数と、それが依存し得る変数のラベルです
+     */
+    struct item {
+        F f;
+        std::vector<label_type> support;
+    };
+
+    table_type& table;
+    conjoin_schedule schedule;
+    std::vector<size_t> labels;
+    /*! 存在量化する DIMACS の変数の番号 */
+    std::vector<size_t> quantified_variables;
+    /*! build() の間だけ用いる、存在量化する変数のラベル */
+    std::vector<label_type> quantified;
+    cnf_statistics stats;
+
+    label_type label_of(const size_t v) const {
+        return static_cast<label_type>(v - 1 < labels.size() ? labels[v - 1] : v - 1);
+    }
+
+    bool is_quantified(const label_type& l) const {
+        return std::binary_search(quantified.begin(), quantified.end(), l);
+    }
+
+    void record() {
+        ++stats.conjunctions;
+        stats.peak_nodes = std::max(stats.peak_nodes, table.size());
+    }
+
+    F conjoin(const F& a, const F& b) {
+        const F r = a & b;
+        record();
+        return r;
+    }
+
+    item clause(const std::vector<int>& c) {
+        std::vector<std::pair<label_type, bool>> literals;
+        for (const int l : c) literals.emplace_back(label_of(static_cast<size_t>(std::abs(l))), l > 0);
+        // 根から遠い変数から順に論理和を取る
+        std::sort(literals.begin(), literals.end(),
+                [this](const std::pair<label_type, bool>& a, const std::pair<label_type, bool>& b) {
+            return table.level(a.first) > table.level(b.first);
+        });
+        item r{F::zero(table), {}};
+        for (const auto& l : literals) {
+            const F x(table, l.first);
+            r.f = r.f | (l.second ? x : ~x);
+            r.support.push_back(l.first);
+        }
+        std::sort(r.support.begin(), r.support.end());
+        r.support.erase(std::unique(r.support.begin(), r.support.end()), r.support.end());
+        return r;
+    }
+
+    F quantify_rest(const F& f) {
+        return quantified.empty() ? f : f.exists(quantified);
+    }
+
+    F balanced(std::vector<F> fs) {
+        if (fs.empty()) return F::one(table);
+        while (fs.size() > 1) {
+            std::vector<F> next;
+            for (size_t i = 0; i + 1 < fs.size(); i += 2) next.push_back(conjoin(fs[i], fs[i + 1]));
+            if (fs.size() % 2) next.push_back(fs.back());
+            fs.swap(next);
+        }
+        return fs[0];
+    }
+
+    F smallest_first(const std::vector<item>& items) {
+        using entry = std::tuple<size_t, size_t, F>;
+        const auto greater = [](const entry& a, const entry& b) {
+            return std::get<0>(a) != std::get<0>(b) ? std::get<0>(a) > std::get<0>(b) : std::get<1>(a) > std::get<1>(b);
+        };
+        std::priority_queue<entry, std::vector<entry>, decltype(greater)> queue(greater);
+        size_t seq = 0;
+        for (const auto& i : items) queue.emplace(i.f.size(), seq++, i.f);
+        if (queue.empty()) return quantify_rest(F::one(table));
+        while (queue.size() > 1) {
+            const F a = std::get<2>(queue.top());
+            queue.pop();
+            const F b = std::get<2>(queue.top());
+            queue.pop();
+            const F r = conjoin(a, b);
+            if (r == F::zero(table)) return r;
+            queue.emplace(r.size(), seq++, r);
+        }
+        return quantify_rest(std::get<2>(queue.top()));
+    }
+
+    F bucket(std::vector<item> items) {
+        // 根から遠い変数のバケットから処理する
+        const auto level = [this](const label_type& l) -> size_t {
+            return static_cast<size_t>(table.level(l));
+        };
+        const auto bottom = [&](const std::vector<label_type>& support, const size_t below) -> size_t {
+            size_t b = below;
+            for (const label_type l : support) {
+                const size_t v = level(l);
+                if (v < below && (b == below || v > b)) b = v;
+            }
+            return b;
+        };
+        const size_t none = std::numeric_limits<size_t>::max();
+        // 変数を含む関数は全て、その変数のバケットを通ってから根に近いバケットへ移る
+        std::map<size_t, std::vector<item>> buckets;
+        std::vector<F> rest;
+        for (auto& i : items) {
+            const size_t b = bottom(i.support, none);
+            if (b == none) rest.push_back(i.f);
+            else buckets[b].push_back(std::move(i));
+        }
+        while (!buckets.empty()) {
+            const auto last = std::prev(buckets.end());
+            const size_t current = last->first;
+            std::vector<item> members = std::move(last->second);
+            buckets.erase(last);
+
+            std::vector<label_type> support;
+            std::vector<F> fs;
+            for (const auto& m : members) {
+                support.insert(support.end(), m.support.begin(), m.support.end());
+                fs.push_back(m.f);
+            }
+            std::sort(support.begin(), support.end());
+            support.erase(std::unique(support.begin(), support.end()), support.end());
+            // バケットの変数は、この位置にあるラベルです
+            label_type v = support[0];
+            for (const label_type l : support) {
+                if (level(l) == current) v = l;
+            }
+            const bool eliminate = is_quantified(v);
+
+            F r = F::one(table);
+            if (eliminate) {
+                // 最後の論理積と量化をまとめて行う
+                const F last_f = fs.back();
+                fs.pop_back();
+                r = balanced(fs).and_exists(last_f, {v});
+                record();
+                support.erase(std::remove(support.begin(), support.end(), v), support.end());
+            }
+            else {
+                r = balanced(fs);
+            }
+            if (r == F::zero(table)) return r;
+            const size_t b = bottom(support, current);
+            if (b == current) rest.push_back(r);
+            else buckets[b].push_back(item{r, support});
+        }
+        // 量化する変数は全て、そのバケットで量化し終えている
+        return balanced(rest);
+    }
+
+public:
+
+    /*!
+     * @brief コンストラクタ
+     *
+     * @param t 論理関数を生成するテーブル
+     * @param s 論理積を取る順序の方針
+     */
+    explicit cnf_builder(table_type& t, const conjoin_schedule s = conjoin_schedule::bucket) :
+            table(t), schedule(s)
+    {}
+
+    /*!
+     * @brief 変数に用いるラベルを設定します
+     *
+     * 設定しない場合、DIMACS の変数 v にはラベル v - 1 を用います。
+     *
+     * @param l 0 から始まる変数の番号を添字とするラベル。force_order などの結果をそのまま渡せます
+     */
+    void set_labels(const std::vector<size_t>& l) {
+        labels = l;
+    }
+
+    /*!
+     * @brief 存在量化する変数を設定します
+     *
+     * 変数はラベルに変換せずに保持し、build() の時点のラベルを用います。
+     * そのため set_labels() と呼び出す順序は問いません。
+     * 0 を含む場合は std::invalid_argument を送出します。
+     *
+     * @param variables 1 から始まる DIMACS の変数の番号
+     */
+    void set_quantified(const std::vector<size_t>& variables) {
+        if (std::find(variables.begin(), variables.end(), size_t(0)) != variables.end()) {
+            throw std::invalid_argument("boloq: DIMACS variables start from 1");
+        }
+        quantified_variables = variables;
+    }
+
+    /*!
+     * next() が返す節を順に論理関数に変換します
+     */
+    template<class Next>
+    F build_from(Next next) {
+        quantified.clear();
+        for (const size_t v : quantified_variables) quantified.push_back(label_of(v));
+        std::sort(quantified.begin(), quantified.end());
+        quantified.erase(std::unique(quantified.begin(), quantified.end()), quantified.end());
+
+        stats = cnf_statistics();
+        stats.peak_nodes = table.size();
+        if (schedule == conjoin_schedule::linear) {
+            F r = F::one(table);
+            while (const std::vector<int>* c = next()) r = conjoin(r, clause(*c).f);
+            return quantify_rest(r);
+        }
+        if (schedule == conjoin_schedule::balanced) {
+            // 二進の繰り上がりと同じく、同じ数の節をまとめたもの同士の論理積を取る
+            std::vector<std::pair<size_t, F>> partial;
+            while (const std::vector<int>* c = next()) {
+                F f = clause(*c).f;
+                size_t rank = 0;
+                while (!partial.empty() && partial.back().first == rank) {
+                    f = conjoin(partial.back().second, f);
+                    partial.pop_back();
+                    ++rank;
+                }
+                partial.emplace_back(rank, f);
+            }
+            if (partial.empty()) return quantify_rest(F::one(table));
+            F r = partial.back().second;
+            for (size_t i = partial.size() - 1; i-- > 0;) r = conjoin(partial[i].second, r);
+            return quantify_rest(r);
+        }
+
+        std::vector<item> items;
+        while (const std::vector<int>* c = next()) items.push_back(clause(*c));
+        if (schedule == conjoin_schedule::smallest_first) return smallest_first(items);
+        return bucket(std::move(items));
+    }
+
+    /*!
+     * @brief CNF を論理関数に変換します
+     */
+    F build(const cnf_formula& cnf) {
+        size_t k = 0;
+        return build_from([&cnf, &k]() -> const std::vector<int>* {
+            return (k < cnf.clauses.size()) ? &cnf.clauses[k++] : nullptr;
+        });
+    }
+
+    /*!
+     * @brief 節を読みながら論理関数に変換します
+     *
+     * 節の一覧を保持しないため、read_dimacs で読み込んでから変換するより少ないメモリで済みます。
+     */
+    F build(dimacs_reader& reader) {
+        return build_from([&reader]() { return reader.next(); });
+    }
+
+    /*!
+     * @brief 直前の変換の統計情報を返します
+     */
+    const cnf_statistics& statistics() const {return stats;}
+};
+
+}
@@ -0,0 +1,216 @@
+#pragma once
+
+namespace boloq {
+
+/*!
+ * @brief 出力をまとめてストリームへ書き出すバッファです
+ *
+ * 小さな書き込みを溜めておき、一定の大きさを超えたときにまとめて書き出します。
+ * 破棄するときに残りを書き出します。
+ */
+class buffered_sink {
+private:
+    std::ostream& os;
+    std::string buffer;
+    static constexpr size_t capacity = 1 << 16;
+
+public:
+
+    explicit buffered_sink(std::ostream& o) : os(o) {
+        buffer.reserve(capacity);
+    }
+
+    buffered_sink(const buffered_sink&) = delete;
+    buffered_sink& operator=(const buffered_sink&) = delete;
+
+    ~buffered_sink() {
+        flush();
+    }
+
+    buffered_sink& operator<<(const char* s) {
+        buffer += s;
+        if (buffer.size() >= capacity) flush();
+        return *this;
+    }
+
+    buffered_sink& operator<<(const std::string& s) {
+        buffer += s;
+        if (buffer.size() >= capacity) flush();
+        return *this;
+    }
+
+    buffered_sink& operator<<(const char c) {
+        buffer += c;
+        if (buffer.size() >= capacity) flush();
+        return *this;
+    }
+
+    buffered_sink& operator<<(const uint64_t v) {
+        return *this << std::to_string(v);
+    }
+
+    /*!
+     * @brief 溜めた出力をストリームへ書き出します
+     */
+    void flush() {
+        os.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        buffer.clear();
+    }
+};
+
+/*!
+ * @brief 図を共有した DAG のまま書き出すクラスです
+ *
+ * 全ての根から辿れるノードを一度ずつ集め、根に近い変数から順に並べて番号を振ります。
+ * 番号は 0 と 1 が定節点で、ノードには 2 から振ります。
+ * 各ノードは一度だけ書き出すため、出力の大きさはノードの数に比例します。
+ *
+ * @tparam F 論理関数または組み合わせ集合の型
+ */
+template<class F>
+class diagram_exporter {
+private:
+    using node_ptr = typename F::node_ptr;
+
+    struct root_visitor {
+        using result_type = node_ptr;
+        node_ptr operator()(const node_ptr& n) const {return n;}
+    };
+
+    /*!
+     * 番号を振ったノードです
+     */
+    struct entry {
+        uint64_t label;
+        uint64_t level;
+        uint64_t then_id;
+        uint64_t else_id;
+    };
+
+    std::vector<uint64_t> roots;
+    std::vector<entry> entries;
+
+public:
+
+    /*!
+     * @brief 同じテーブルに属する図のノードを集めます
+     */
+    explicit diagram_exporter(const std::vector<F>& fs) {
+        std::vector<node_ptr> root_nodes;
+        for (const auto& f : fs) {
+            if (&f.manager() != &fs[0].manager()) {
+                throw std::invalid_argument("boloq: diagrams belong to different managers");
+            }
+            root_nodes.push_back(f.accept(root_visitor()));
+        }
+
+        node_scratch<uint64_t> ids;
+        ids.reset();
+        std::vector<node_ptr> order, stack;
+        for (const auto& r : root_nodes) {
+            if (!r->is_terminal()) stack.push_back(r);
+            while (!stack.empty()) {
+                const node_ptr m = stack.back();
+                stack.pop_back();
+                if (ids.contains(static_cast<size_t>(m->index()))) continue;
+                ids.set(static_cast<size_t>(m->index()), 0);
+                order.push_back(m);
+                const node_ptr t = m->then_node(), e = m->else_node();
+                if (!t->is_terminal()) stack.push_back(t);
+                if (!e->is_terminal()) stack.push_back(e);
+            }
+        }
+        if (!fs.empty()) {
+            const auto& t = fs[0].manager();
+            std::stable_sort(order.begin(), order.end(), [&t](const node_ptr& a, const node_ptr& b) {
+                return t.level(a->label()) < t.level(b->label());
+            });
+        }
+        for (size_t k = 0; k < order.size(); k++) ids.set(static_cast<size_t>(order[k]->index()), k + 2);
+        const auto id = [&ids](const node_ptr& n) -> uint64_t {
+            if (n->is_terminal()) return n->index() ? 1 : 0;
+            return ids.get(static_cast<size_t>(n->index()));
+        };
+
+        entries.reserve(order.size());
+        for (const auto& m : order) {
+            entries.push_back(entry{
+                static_cast<uint64_t>(m->label()),
+                static_cast<uint64_t>(fs[0].manager().level(m->label())),
+                id(m->then_node()), id(m->else_node())});
+        }
+        for (const auto& r : root_nodes) roots.push_back(id(r));
+    }
+
+    /*!
+     * @brief Graphviz の DOT 形式で書き出します
+     *
+     * 同じ変数のノードを rank=same で同じ段に並べます。
+     * 1枝は実線、0枝は破線で表します。
+     */
+    void write_dot(std::ostream& os) const {
+        buffered_sink out(os);
+        out << "digraph boloq {\n";
+        out << "  t0 [shape=box,label=\"0\"];\n  t1 [shape=box,label=\"1\"];\n";
+        const auto node = [](const uint64_t i) -> std::string {
+            return (i < 2 ? "t" : "n") + std::to_string(i);
+        };
+        for (size_t k = 0; k < roots.size(); k++) {
+            out << "  r" << static_cast<uint64_t>(k) << " [shape=plaintext,label=\"f" << static_cast<uint64_t>(k) << "\"];\n";
+            out << "  r" << static_cast<uint64_t>(k) << " -> " << node(roots[k]) << ";\n";
+        }
+        for (size_t k = 0; k < entries.size();) {
+            out << "  { rank=same;";
+            const uint64_t level = entries[k].level;
+            for (; k < entries.size() && entries[k].level == level; k++) {
+                out << ' ' << node(k + 2) << " [label=\"" << entries[k].label << "\"];";
+            }
+            out << " }\n";
+        }
+        for (size_t k = 0; k < entries.size(); k++) {
+            out << "  " << node(k + 2) << " -> " << node(entries[k].then_id) << ";\n";
+            out << "  " << node(k + 2) << " -> " << node(entries[k].else_id) << " [style=dashed];\n";
+        }
+        out << "}\n";
+    }
+
+    /*!
+     * @brief JSON で書き出します
+     *
+     * {"roots": [番号, ...], "nodes": [{"id", "label", "level", "then", "else"}, ...]} の形です。
+     */
+    void write_json(std::ostream& os) const {
+        buffered_sink out(os);
+        out << "{\"roots\":[";
+        for (size_t k = 0; k < roots.size(); k++) {
+            if (k) out << ',';
+            out << roots[k];
+        }
+        out << "],\"nodes\":[";
+        for (size_t k = 0; k < entries.size(); k++) {
+            const entry& e = entries[k];
+            if (k) out << ',';
+            out << "\n{\"id\":" << static_cast<uint64_t>(k + 2) << ",\"label\":" << e.label
+                << ",\"level\":" << e.level << ",\"then\":" << e.then_id << ",\"else\":" << e.else_id << '}';
+        }
+        out << "]}\n";
+    }
+
+    /*!
+     * @brief 1行に1ノードの辺の一覧で書き出します
+     *
+     * 先頭の行は "p ノードの数 根の数"、続いて各ノードを "n 番号 ラベル 1枝 0枝"、
+     * 最後に各根を "r 番号" の行で表します。
+     */
+    void write_edge_list(std::ostream& os) const {
+        buffered_sink out(os);
+        out << "p " << static_cast<uint64_t>(entries.size()) << ' ' << static_cast<uint64_t>(roots.size()) << '\n';
+        for (size_t k = 0; k < entries.size(); k++) {
+            const entry& e = entries[k];
+            out << "n " << static_cast<uint64_t>(k + 2) << ' ' << e.label << ' ' << e.then_id << ' ' << e.else_id << '\n';
+        }
+        for (const uint64_t r : roots) out << "r " << r << '\n';
+    }
+};
+
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+namespace boloq {
+
+/*!
+ * @brief 独立したテーブルを持つ論理関数や組み合わせ集合の管理オブジェクトです
+ *
+ * 型ごとに1つだけ存在する既定のテーブルとは別に、任意の数のテーブルを作ることができます。
+ * マネージャから生成した論理関数や組み合わせ集合はそのマネージャのテーブルで演算され、
+ * 異なるマネージャに属するものどうしの演算は std::invalid_argument を送出します。
+ *
+ * マネージャを破棄すると、ノードと演算キャッシュはまとめて解放されます。
+ * アリーナに格納されるノードを用いる場合は、ノードごとの解放は行われません。
+ * マネージャより長く生存する論理関数や組み合わせ集合を残してはいけません。
+ *
+ * @tparam F 論理関数または組み合わせ集合の型
+ */
+template<class F>
+class basic_manager {
+public:
+    /*! @brief 生成される論理関数または組み合わせ集合の型 */
+    using value_type = F;
+    /*! @brief 演算に用いられるテーブルの型 */
+    using table_type = typename value_type::table_type;
+    /*! @brief ラベルの型 */
+    using label_type = typename value_type::label_type;
+
+private:
+    table_type _table;
+
+public:
+
+    basic_manager() {}
+
+    /*! @brief コピーは禁止されています */
+    basic_manager(const basic_manager&) = delete;
+    /*! @brief 代入は禁止されています */
+    basic_manager& operator=(const basic_manager&) = delete;
+
+    /*!
+     * @brief 変数を生成します
+     */
+    value_type var(const label_type& l) {
+        return value_type(_table, l);
+    }
+
+    /*!
+     * @brief 0 定節点
+     */
+    value_type zero() {
+        return value_type::zero(_table);
+    }
+
+    /*!
+     * @brief 1 定節点
+     */
+    value_type one() {
+        return value_type::one(_table);
+    }
+
+    /*!
+     * @brief 演算に用いられるテーブルを返します
+     */
+    table_type& table() {
+        return _table;
+    }
+};
+
+}
@@ -0,0 +1,380 @@
+#pragma once
+
+namespace boloq {
+
+/*!
+ * @brief 配置形式の先頭に置くヘッダです
+ */
+struct mapped_header {
+    /*! @brief "BOLQMAP" と終端の 0 */
+    char magic[8];
+    /*! @brief 版。現在は 1 です */
+    uint32_t version;
+    /*! @brief 種類。'B' か 'Z' です */
+    uint32_t kind;
+    /*! @brief 定節点の 2 行を含む行の数 */
+    uint64_t count;
+    /*! @brief 根の行 */
+    uint64_t root;
+    /*! @brief 行の表の FNV-1a ハッシュ。basic_mapped_diagram::validate() で確かめます */
+    uint64_t records_checksum;
+    /*! @brief ここより前のヘッダの FNV-1a ハッシュ */
+    uint64_t header_checksum;
+};
+
+/*!
+ * @brief 配置形式の検査に用いる FNV-1a ハッシュを返します
+ */
+inline uint64_t mapped_checksum(const void* data, const size_t size) {
+    fnv1a_checksum checksum;
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < size; i++) checksum.update(p[i]);
+    return checksum.value();
+}
+
+/*!
+ * @brief 配置形式の各行です
+ *
+ * 子は行の位置で参照するため、どのアドレスに配置しても使えます。
+ */
+struct mapped_record {
+    /*! @brief 変数のラベル */
+    uint32_t label;
+    /*! @brief 変数の順序における位置 */
+    uint32_t level;
+    /*! @brief 0枝と 1枝の子の行 */
+    uint32_t next[2];
+};
+
+/*!
+ * @brief 配置形式の行を指すハンドルです
+ *
+ * path_iterator などからノードと同じように -> で参照できます。
+ * 子を辿る時に子が親より前の行であることを確かめ、壊れた表では std::invalid_argument を送出します。
+ */
+class mapped_node {
+private:
+    const mapped_record* records;
+    uint32_t i;
+
+public:
+    /*! @brief ラベルの型 */
+    using label_type = uint32_t;
+
+    mapped_node(const mapped_record* r, const uint32_t index) : records(r), i(index) {}
+
+    const mapped_node* operator->() const {return this;}
+
+    bool is_terminal() const {return i < 2;}
+    uint32_t index() const {return i;}
+    label_type label() const {return records[i].label;}
+    mapped_node then_node() const {return child(1);}
+    mapped_node else_node() const {return child(0);}
+
+    /*!
+     * @brief 0枝か 1枝の子を返します
+     */
+    mapped_node child(const int b) const {
+        const uint32_t c = records[i].next[b];
+        if (c >= i) throw std::invalid_argument("boloq: invalid child in mapped diagram");
+        return mapped_node(records, c);
+    }
+
+    bool operator==(const mapped_node& o) const {return i == o.i;}
+    bool operator!=(const mapped_node& o) const {return i != o.i;}
+};
+
+/*!
+ * @brief 図を配置形式で書き出します
+ *
+ * 配置形式はヘッダに続いて、子が先に来る順に並べた mapped_record の表です。
+ * 先頭の 2 行は定節点を表します。
+ * バイト順は書き出した環境のものであり、同じバイト順の環境でのみ読めます。
+ *
+ * @tparam F 論理関数または組み合わせ集合の型
+ */
+template<class F>
+class mapped_writer {
+private:
+    using node_ptr = typename F::node_ptr;
+
+    struct root_visitor {
+        using result_type = node_ptr;
+        node_ptr operator()(const node_ptr& n) const {return n;}
+    };
+
+    std::ostream& os;
+
+public:
+
+    /*!
+     * @brief コンストラクタ
+     */
+    explicit mapped_writer(std::ostream& o) : os(o) {}
+
+    /*!
+     * @brief 図を書き出します
+     */
+    void write(const F& f) {
+        const node_ptr root = f.accept(root_visitor());
+        const auto& table = f.manager();
+        const uint32_t terminal = std::numeric_limits<uint32_t>::max();
+
+        std::vector<mapped_record> records;
+        records.push_back(mapped_record{terminal, terminal, {0, 0}});
+        records.push_back(mapped_record{terminal, terminal, {1, 1}});
+        node_scratch<uint32_t> rows;
+        rows.reset();
+        const auto row = [&rows](const node_ptr& n) -> uint32_t {
+            if (n->is_terminal()) return n->index() ? 1 : 0;
+            return rows.get(static_cast<size_t>(n->index()));
+        };
+        const auto narrow = [](const uint64_t v) -> uint32_t {
+            if (v >= std::numeric_limits<uint32_t>::max()) {
+                throw std::length_error("boloq: diagram too large for the mapped layout");
+            }
+            return static_cast<uint32_t>(v);
+        };
+
+        // 子を先に並べるため後順に辿る
+        std::vector<std::pair<node_ptr, bool>> stack;
+        if (!root->is_terminal()) stack.emplace_back(root, false);
+        while (!stack.empty()) {
+            const node_ptr m = stack.back().first;
+            if (rows.contains(static_cast<size_t>(m->index()))) {
+                stack.pop_back();
+                continue;
+            }
+            if (!stack.back().second) {
+                stack.back().second = true;
+                const node_ptr t = m->then_node(), e = m->else_node();
+                if (!t->is_terminal()) stack.emplace_back(t, false);
+                if (!e->is_terminal()) stack.emplace_back(e, false);
+            }
+            else {
+                stack.pop_back();
+                const uint32_t lo = row(m->else_node()), hi = row(m->then_node());
+                records.push_back(mapped_record{
+                    narrow(static_cast<uint64_t>(m->label())),
+                    narrow(static_cast<uint64_t>(table.level(m->label()))),
+                    {lo, hi}});
+                rows.set(static_cast<size_t>(m->index()), narrow(records.size() - 1));
+            }
+        }
+
+        mapped_header h;
+        std::memcpy(h.magic, "BOLQMAP", 8);
+        h.version = 1;
+        h.kind = static_cast<uint32_t>(diagram_kind<F>::value);
+        h.count = records.size();
+        h.root = row(root);
+        h.records_checksum = mapped_checksum(records.data(), records.size() * sizeof(mapped_record));
+        h.header_checksum = mapped_checksum(&h, offsetof(mapped_header, header_checksum));
+        os.write(reinterpret_cast<const char*>(&h), sizeof(h));
+        os.write(reinterpret_cast<const char*>(records.data()),
+                 static_cast<std::streamsize>(records.size() * sizeof(mapped_record)));
+        if (!os) throw std::runtime_error("boloq: failed to write diagram");
+    }
+};
+
+/*!
+ * @brief 配置形式の図を、複製せずにそのまま参照する読み取り専用のクラスです
+ *
+ * mapped_file で写像したファイルなどを参照します。
+ * 複数のプロセスが同じファイルを写像すれば、ページは共有されます。
+ * 参照先の領域はこのオブジェクトより長く生存しなければなりません。
+ *
+ * 生成時にはヘッダと領域の大きさだけを確かめ、表の大きさによらず直ちに使えます。
+ * 子の行は辿る時に親より前の行であることを確かめるため、
+ * 壊れたファイルを参照しても走査が範囲外に出たり終わらなかったりすることはなく、
+ * std::invalid_argument が送出されます。
+ * 表全体を前もって確かめるには validate() を呼び出します。
+ *
+ * @tparam Sets 組み合わせ集合であるかどうか
+ */
+template<bool Sets>
+class basic_mapped_diagram {
+public:
+    /*! @brief ラベルの型 */
+    using label_type = uint32_t;
+    /*! @brief ノードの型 */
+    using node_ptr = mapped_node;
+    /*! @brief 要素を列挙するイテレータの型 */
+    using iterator = path_iterator<basic_mapped_diagram<Sets>, Sets>;
+
+private:
+    const mapped_header* header;
+    const mapped_record* records;
+    uint64_t rows;
+    uint32_t root;
+
+    static void fail(const char* what) {
+        throw std::invalid_argument(std::string("boloq: ") + what);
+    }
+
+    /*!
+     * i 行目の子の行を返します。子が親より前の行でなければ例外を送出します
+     */
+    uint32_t child(const uint32_t i, const int b) const {
+        const uint32_t c = records[i].next[b];
+        if (c >= i) fail("invalid child in mapped diagram");
+        return c;
+    }
+
+    uint32_t level(const uint32_t i, const size_t nvars) const {
+        if (i < 2) return static_cast<uint32_t>(nvars);
+        if (records[i].level >= nvars) {
+            throw std::invalid_argument("boloq: variable out of range for satcount");
+        }
+        return records[i].level;
+    }
+
+public:
+
+    /*!
+     * @brief 領域を参照します
+     *
+     * @param data 配置形式の先頭。mapped_record の境界に揃っていなければなりません
+     * @param size 領域のバイト数
+     */
+    basic_mapped_diagram(const void* data, const size_t size) {
+        if (reinterpret_cast<uintptr_t>(data) % alignof(mapped_header) != 0) fail("misaligned mapped diagram");
+        if (size < sizeof(mapped_header)) fail("not a mapped diagram");
+        const mapped_header* h = static_cast<const mapped_header*>(data);
+        if (std::memcmp(h->magic, "BOLQMAP", 8) != 0) fail("not a mapped diagram");
+        if (h->version != 1) fail("unsupported mapped diagram version");
+        if (h->kind != static_cast<uint32_t>(Sets ? 'Z' : 'B')) fail("mapped diagram kind mismatch");
+        if (h->count < 2 || h->count > (size - sizeof(mapped_header)) / sizeof(mapped_record)) {
+            fail("truncated mapped diagram");
+        }
+        if (h->header_checksum != mapped_checksum(h, offsetof(mapped_header, header_checksum))) {
+            fail("mapped diagram header checksum mismatch");
+        }
+        if (h->count < 2 || h->count > (size - sizeof(mapped_header)) / sizeof(mapped_record)) {
+            fail("truncated mapped diagram");
+        }
+        if (h->root >= h->count) fail("invalid root in mapped diagram");
+        header = h;
+        records = reinterpret_cast<const mapped_record*>(h + 1);
+        rows = h->count;
+        root = static_cast<uint32_t>(h->root);
+    }
+
+    /*!
+     * @brief 表全体を確かめます
+     *
+     * 行の表のハッシュと、全ての子が親より前の行にあり変数の順序を守ることを確かめます。
+     * 表の大きさに比例する時間がかかるため、生成時には行いません。
+     *
+     * @throw std::invalid_argument 表が壊れている場合
+     */
+    void validate() const {
+        if (header->records_checksum != mapped_checksum(records, static_cast<size_t>(rows) * sizeof(mapped_record))) {
+            fail("mapped diagram checksum mismatch");
+        }
+        for (uint32_t i = 2; i < rows; i++) {
+            for (int b = 0; b < 2; b++) {
+                const uint32_t c = child(i, b);
+                if (c >= 2 && records[c].level <= records[i].level) fail("mapped diagram does not respect the variable order");
+            }
+        }
+    }
+
+    /*!
+     * @brief 定節点を除いたノードの数を返します
+     */
+    size_t size() const {return static_cast<size_t>(rows - 2);}
+
+    /*!
+     * @brief 論理関数を評価します
+     *
+     * @param inputs ラベルを添字とする変数の値
+     */
+    bool evaluate(const bool* inputs) const {
+        static_assert(!Sets, "evaluate() requires a boolean function");
+        uint32_t i = root;
+        while (i > 1) i = child(i, inputs[records[i].label] ? 1 : 0);
+        return i != 0;
+    }
+
+    /*!
+     * @brief 集合を要素として含むかどうかを返します
+     *
+     * @param labels 集合に含まれるラベル
+     */
+    template<class C>
+    bool contains(const C& labels) const {
+        static_assert(Sets, "contains() requires a combination");
+        std::vector<uint32_t> s(std::begin(labels), std::end(labels));
+        std::sort(s.begin(), s.end());
+        s.erase(std::unique(s.begin(), s.end()), s.end());
+        size_t taken = 0;
+        uint32_t i = root;
+        while (i > 1) {
+            const bool in = std::binary_search(s.begin(), s.end(), records[i].label);
+            taken += in;
+            i = child(i, in ? 1 : 0);
+        }
+        return i != 0 && taken == s.size();
+    }
+
+    /*!
+     * @brief 1-節点に至る経路の数を返します
+     *
+     * 組み合わせ集合では要素の数、論理関数では互いに素なキューブの数です。
+     * 表を先頭から一度走査して求めます。
+     *
+     * @tparam R 結果の型。count_traits を参照してください
+     */
+    template<class R = uint64_t>
+    R count() const {
+        using traits = count_traits<R>;
+        std::vector<R> values(static_cast<size_t>(rows), traits::zero());
+        values[1] = traits::one();
+        for (uint32_t i = 2; i < values.size(); i++) {
+            values[i] = traits::add(values[child(i, 0)], values[child(i, 1)]);
+        }
+        return values[root];
+    }
+
+    /*!
+     * @brief 論理関数を真にする割り当ての数を返します
+     *
+     * 変数の順序で先頭から nvars 個の変数についての割り当てを数えます。
+     *
+     * @tparam R 結果の型。count_traits を参照してください
+     */
+    template<class R = uint64_t>
+    R satcount(const size_t nvars) const {
+        static_assert(!Sets, "satcount() requires a boolean function");
+        using traits = count_traits<R>;
+        std::vector<R> values(static_cast<size_t>(rows), traits::zero());
+        values[1] = traits::one();
+        for (uint32_t i = 2; i < values.size(); i++) {
+            const uint32_t l = level(i, nvars);
+            R sum = traits::zero();
+            for (int b = 0; b < 2; b++) {
+                const uint32_t c = child(i, b), lc = level(c, nvars);
+                if (lc <= l) fail("mapped diagram does not respect the variable order");
+                sum = traits::add(sum, traits::shift(values[c], lc - l - 1));
+            }
+            values[i] = sum;
+        }
+        return traits::shift(values[root], level(root, nvars));
+    }
+
+    /*!
+     * @brief 要素を列挙するイテレータを返します
+     *
+     * 論理関数ではキューブを、組み合わせ集合では集合を返します。
+     */
+    iterator begin() const {return iterator(mapped_node(records, root));}
+    iterator end() const {return iterator();}
+};
+
+/*! @brief 配置形式の論理関数 */
+using mapped_boolean_function = basic_mapped_diagram<false>;
+/*! @brief 配置形式の組み合わせ集合 */
+using mapped_combination = basic_mapped_diagram<true>;
+
+}
@@ -0,0 +1,408 @@
+#pragma once
+
+namespace boloq {
+
+/*!
+ * @brief 積和形の被覆で論理を表したゲートです
+ *
+ * 被覆の各行は入力と同じ長さの文字列で、'1' は肯定、'0' は否定、'-' は任意を表します。
+ * 行の論理和が onset なら出力の 1 を、そうでなければ 0 を表します。
+ * 入力のないゲートは、行があれば定数 1 を、なければ定数 0 を onset とします。
+ */
+struct logic_gate {
+    /*! @brief ゲートの出力の信号 */
+    size_t output;
+    /*! @brief ゲートの入力の信号 */
+    std::vector<size_t> inputs;
+    /*! @brief 被覆の行 */
+    std::vector<std::string> cover;
+    /*! @brief 被覆が 1 を表すかどうか */
+    bool onset;
+};
+
+/*!
+ * @brief 組み合わせ回路です
+ *
+ * 信号は整数で表し、0 から inputs - 1 までの信号を外部入力とします。
+ */
+struct logic_netlist {
+    /*! @brief 外部入力の数 */
+    size_t inputs;
+    /*! @brief 外部入力の名前 */
+    std::vector<std::string> input_names;
+    /*! @brief ゲートの一覧 */
+    std::vector<logic_gate> gates;
+    /*! @brief 外部出力の信号 */
+    std::vector<size_t> outputs;
+    /*! @brief 外部出力の名前 */
+    std::vector<std::string> output_names;
+
+    logic_netlist() : inputs(0) {}
+
+    /*!
+     * @brief 接続だけを取り出します
+     *
+     * dfs_order に渡して変数の順序を求めるのに用います。
+     */
+    std::vector<netlist_gate> structure() const {
+        std::vector<netlist_gate> r;
+        for (const auto& g : gates) r.push_back(netlist_gate{g.output, g.inputs});
+        return r;
+    }
+};
+
+/*!
+ * @brief AIGER 形式 (aag と aig) の組み合わせ回路を読み込みます
+ *
+ * ラッチを含む回路は扱えません。シンボル表とコメントは読み飛ばします。
+ * 形式が正しくない場合は std::runtime_error を送出します。
+ */
+inline logic_netlist read_aiger(std::istream& is) {
+    const auto fail = [](const char* what) {
+        throw std::runtime_error(std::string("boloq: ") + what);
+    };
+    const auto read = [&](size_t& v) {
+        if (!(is >> v)) fail("malformed AIGER file");
+    };
+
+    std::string format;
+    size_t m, i, l, o, a;
+    if (!(is >> format) || (format != "aag" && format != "aig")) fail("not an AIGER file");
+    read(m); read(i); read(l); read(o); read(a);
+    if (l != 0) fail("sequential AIGER netlists are not supported");
+    if (m < i + a) fail("malformed AIGER header");
+    const bool binary = (format == "aig");
+
+    std::vector<size_t> input_literals(i), output_literals(o);
+    std::vector<std::array<size_t, 3>> ands(a);
+    if (binary) {
+        for (size_t k = 0; k < i; k++) input_literals[k] = 2 * (k + 1);
+    }
+    else {
+        for (auto& lit : input_literals) read(lit);
+    }
+    for (auto& lit : output_literals) read(lit);
+    if (binary) {
+        // 改行を読み飛ばし、差分を 7bit ずつの可変長で読む
+        if (is.get() != '\n') fail("malformed AIGER file");
+        const auto delta = [&]() -> size_t {
+            size_t v = 0;
+            for (size_t shift = 0;; shift += 7) {
+                const auto c = is.get();
+                if (c == std::char_traits<char>::eof() || shift > 63) fail("malformed AIGER file");
+                v |= static_cast<size_t>(c & 0x7f) << shift;
+                if (!(c & 0x80)) return v;
+            }
+        };
+        for (size_t k = 0; k < a; k++) {
+            const size_t lhs = 2 * (i + k + 1);
+            const size_t d0 = delta(), d1 = delta();
+            if (d0 > lhs || d1 > lhs - d0) fail("malformed AIGER file");
+            ands[k] = {{lhs, lhs - d0, lhs - d0 - d1}};
+        }
+    }
+    else {
+        for (auto& g : ands) {
+            read(g[0]); read(g[1]); read(g[2]);
+        }
+    }
+
+    logic_netlist n;
+    n.inputs = i;
+    const size_t none = std::numeric_limits<size_t>::max();
+    std::vector<size_t> signal_of(m + 1, none);
+    for (size_t k = 0; k < i; k++) {
+        const size_t v = input_literals[k] >> 1;
+        if ((input_literals[k] & 1) || v == 0 || v > m || signal_of[v] != none) fail("invalid AIGER input");
+        signal_of[v] = k;
+        n.input_names.push_back("i" + std::to_string(k));
+    }
+    for (size_t k = 0; k < a; k++) {
+        const size_t v = ands[k][0] >> 1;
+        if ((ands[k][0] & 1) || v == 0 || v > m || signal_of[v] != none) fail("invalid AIGER and gate");
+        signal_of[v] = i + k;
+    }
+
+    // 定数と否定は必要になったときにゲートを加える
+    size_t next = i + a, constant = none;
+    const auto signal = [&](const size_t lit) -> size_t {
+        const size_t v = lit >> 1;
+        if (v > m) fail("AIGER literal out of range");
+        if (v == 0) {
+            if (constant == none) {
+                constant = next++;
+                n.gates.push_back(logic_gate{constant, {}, {}, true});
+            }
+            return constant;
+        }
+        if (signal_of[v] == none) fail("undefined AIGER literal");
+        return signal_of[v];
+    };
+    const auto polarity = [](const size_t lit) -> char {return (lit & 1) ? '0' : '1';};
+    for (size_t k = 0; k < a; k++) {
+        const size_t s0 = signal(ands[k][1]), s1 = signal(ands[k][2]);
+        n.gates.push_back(logic_gate{i + k, {s0, s1},
+                {std::string{polarity(ands[k][1]), polarity(ands[k][2])}}, true});
+    }
+    for (size_t k = 0; k < o; k++) {
+        const size_t s = signal(output_literals[k]);
+        if (output_literals[k] & 1) {
+            n.gates.push_back(logic_gate{next, {s}, {"0"}, true});
+            n.outputs.push_back(next++);
+        }
+        else {
+            n.outputs.push_back(s);
+        }
+        n.output_names.push_back("o" + std::to_string(k));
+    }
+    return n;
+}
+
+/*!
+ * @brief BLIF 形式の組み合わせ回路を読み込みます
+ *
+ * .model, .inputs, .outputs, .names, .end を扱います。
+ * .latch や .subckt などを含む回路は扱えません。
+ * 形式が正しくない場合は std::runtime_error を送出します。
+ */
+inline logic_netlist read_blif(std::istream& is) {
+    const auto fail = [](const std::string& what) {
+        throw std::runtime_error("boloq: " + what);
+    };
+
+    // 行の継続とコメントを処理して、空でない論理行を返す
+    const auto next_line = [&is](std::vector<std::string>& tokens) -> bool {
+        tokens.clear();
+        std::string line, physical;
+        while (std::getline(is, physical)) {
+            const size_t hash = physical.find('#');
+            if (hash != std::string::npos) physical.erase(hash);
+            while (!physical.empty() && std::isspace(static_cast<unsigned char>(physical.back()))) physical.pop_back();
+            if (!physical.empty() && physical.back() == '\\') {
+                physical.pop_back();
+                line += physical + " ";
+                continue;
+            }
+            line += physical;
+            std::istringstream ss(line);
+            std::string t;
+            while (ss >> t) tokens.push_back(t);
+            if (!tokens.empty()) return true;
+            line.clear();
+        }
+        std::istringstream ss(line);
+        std::string t;
+        while (ss >> t) tokens.push_back(t);
+        return !tokens.empty();
+    };
+
+    struct names_block {
+        std::vector<std::string> signals;
+        std::vector<std::string> cover;
+        int onset;
+    };
+    std::vector<std::string> inputs, outputs;
+    std::vector<names_block> blocks;
+    std::vector<std::string> tokens;
+    while (next_line(tokens)) {
+        const std::string& k = tokens[0];
+        if (k == ".model") continue;
+        if (k == ".end") break;
+        if (k == ".inputs") {
+            inputs.insert(inputs.end(), tokens.begin() + 1, tokens.end());
+        }
+        else if (k == ".outputs") {
+            outputs.insert(outputs.end(), tokens.begin() + 1, tokens.end());
+        }
+        else if (k == ".names") {
+            if (tokens.size() < 2) fail("BLIF .names without output");
+            blocks.push_back(names_block{std::vector<std::string>(tokens.begin() + 1, tokens.end()), {}, -1});
+        }
+        else if (k[0] == '.') {
+            fail("unsupported BLIF construct " + k);
+        }
+        else {
+            if (blocks.empty()) fail("BLIF cover outside .names");
+            names_block& b = blocks.back();
+            const size_t width = b.signals.size() - 1;
+            std::string cube, value;
+            if (width == 0 && tokens.size() == 1) value = tokens[0];
+            else if (tokens.size() == 2) {
+                cube = tokens[0];
+                value = tokens[1];
+            }
+            else fail("malformed BLIF cover");
+            if (cube.size() != width || value.size() != 1 || (value[0] != '0' && value[0] != '1') ||
+                    cube.find_first_not_of("01-") != std::string::npos) {
+                fail("malformed BLIF cover");
+            }
+            const int v = value[0] - '0';
+            if (b.onset != -1 && b.onset != v) fail("BLIF cover mixes onset and offset");
+            b.onset = v;
+            b.cover.push_back(cube);
+        }
+    }
+
+    logic_netlist n;
+    n.inputs = inputs.size();
+    n.input_names = inputs;
+    std::unordered_map<std::string, size_t> signal_of;
+    for (size_t k = 0; k < inputs.size(); k++) {
+        if (!signal_of.emplace(inputs[k], k).second) fail("duplicate BLIF input " + inputs[k]);
+    }
+    size_t next = inputs.size();
+    for (const auto& b : blocks) {
+        if (!signal_of.emplace(b.signals.back(), next++).second) fail("BLIF signal driven twice: " + b.signals.back());
+    }
+    const auto signal = [&](const std::string& name) -> size_t {
+        const auto it = signal_of.find(name);
+        if (it == signal_of.end()) fail("undriven BLIF signal " + name);
+        return it->second;
+    };
+    for (const auto& b : blocks) {
+        logic_gate g{signal(b.signals.back()), {}, b.cover, b.onset != 0};
+        for (size_t k = 0; k + 1 < b.signals.size(); k++) g.inputs.push_back(signal(b.signals[k]));
+        n.gates.push_back(g);
+    }
+    for (const auto& name : outputs) n.outputs.push_back(signal(name));
+    n.output_names = outputs;
+    return n;
+}
+
+/*!
+ * @brief 回路から論理関数を生成した結果です
+ */
+struct netlist_statistics {
+    /*! @brief 生成中のテーブルのノードの数の最大値 */
+    size_t peak_nodes;
+    /*! @brief 同時に保持したゲートの論理関数の数の最大値 */
+    size_t peak_live;
+
+    netlist_statistics() : peak_nodes(0), peak_live(0) {}
+};
+
+/*!
+ * @brief 組み合わせ回路の外部出力の論理関数を生成します
+ *
+ * 外部出力から辿れるゲートをトポロジカル順に評価します。
+ * ゲートの論理関数は、それを入力とするゲートを全て評価した時点で破棄するため、
+ * 保持する論理関数は評価の途中の境界にあるものだけになります。
+ * 同じ論理を持つゲートはユニークテーブルにより同じノードを共有します。
+ *
+ * @tparam F 論理関数の型
+ */
+template<class F>
+class netlist_builder {
+public:
+    /*! @brief テーブルの型 */
+    using table_type = typename F::table_type;
+    /*! @brief ラベルの型 */
+    using label_type = typename F::label_type;
+
+private:
+    table_type& table;
+    std::vector<size_t> labels;
+    netlist_statistics stats;
+
+    F gate_function(const logic_gate& g, const std::unordered_map<size_t, F>& live) const {
+        F r = F::zero(table);
+        for (const auto& cube : g.cover) {
+            F c = F::one(table);
+            for (size_t k = 0; k < cube.size(); k++) {
+                if (cube[k] == '-') continue;
+                const F& x = live.at(g.inputs[k]);
+                c &= (cube[k] == '1') ? x : ~x;
+            }
+            r |= c;
+        }
+        return g.onset ? r : ~r;
+    }
+
+public:
+
+    /*!
+     * @brief コンストラクタ
+     */
+    explicit netlist_builder(table_type& t) : table(t) {}
+
+    /*!
+     * @brief 外部入力に用いるラベルを設定します
+     *
+     * 設定しない場合、外部入力 i にはラベル i を用います。
+     *
+     * @param l 外部入力を添字とするラベル。dfs_order の結果をそのまま渡せます
+     */
+    void set_labels(const std::vector<size_t>& l) {
+        labels = l;
+    }
+
+    /*!
+     * @brief 外部出力の論理関数を outputs の順に返します
+     *
+     * 組み合わせループがある場合は std::runtime_error を送出します。
+     */
+    std::vector<F> build(const logic_netlist& n) {
+        stats = netlist_statistics();
+        std::unordered_map<size_t, const logic_gate*> driver;
+        for (const auto& g : n.gates) driver[g.output] = &g;
+
+        // 外部出力から後順に辿り、評価の順序とファンアウトの数を求める
+        std::vector<const logic_gate*> order;
+        std::unordered_map<size_t, size_t> fanout;
+        std::unordered_map<size_t, int> state;
+        std::vector<std::pair<size_t, bool>> stack;
+        for (const size_t o : n.outputs) {
+            ++fanout[o];
+            stack.emplace_back(o, false);
+            while (!stack.empty()) {
+                const size_t s = stack.back().first;
+                if (s < n.inputs || state[s] == 2) {
+                    stack.pop_back();
+                    continue;
+                }
+                const auto d = driver.find(s);
+                if (d == driver.end()) throw std::runtime_error("boloq: undriven signal in netlist");
+                if (!stack.back().second) {
+                    if (state[s] == 1) throw std::runtime_error("boloq: combinational loop in netlist");
+                    state[s] = 1;
+                    stack.back().second = true;
+                    for (const size_t i : d->second->inputs) {
+                        ++fanout[i];
+                        stack.emplace_back(i, false);
+                    }
+                }
+                else {
+                    stack.pop_back();
+                    state[s] = 2;
+                    order.push_back(d->second);
+                }
+            }
+        }
+
+        std::unordered_map<size_t, F> live;
+        for (size_t i = 0; i < n.inputs; i++) {
+            if (fanout.count(i)) {
+                live.emplace(i, F(table, static_cast<label_type>(i < labels.size() ? labels[i] : i)));
+            }
+        }
+        for (const logic_gate* g : order) {
+            live.emplace(g->output, gate_function(*g, live));
+            stats.peak_live = std::max(stats.peak_live, live.size());
+            stats.peak_nodes = std::max(stats.peak_nodes, table.size());
+            for (const size_t i : g->inputs) {
+                if (--fanout[i] == 0) live.erase(i);
+            }
+        }
+
+        std::vector<F> result;
+        for (const size_t o : n.outputs) result.push_back(live.at(o));
+        return result;
+    }
+
+    /*!
+     * @brief 直前の生成の統計情報を返します
+     */
+    const netlist_statistics& statistics() const {return stats;}
+};
+
+}
@@ -2,6 +2,9 @@
 
 namespace boloq {
 
+template<class N>
+class basic_node_store;
+
 /*!
  * @brief 基本的なノードのクラス
  */
@@ -17,6 +20,10 @@ public:
     using label_type = LT;
     /*! このクラスのポインタを表す型 */
     using node_ptr = std::shared_ptr<const self_type>;
+    /*! 論理関数や組み合わせ集合が保持するポインタを表す型 */
+    using root_ptr = node_ptr;
+    /*! このクラスを格納するテーブルの型 */
+    using store_type = basic_node_store<self_type>;
 
 private:
     const index_type _index;
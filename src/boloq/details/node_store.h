@@ -0,0 +1,198 @@
+#pragma once
+
+namespace boloq {
+
+/*!
+ * @brief ガベージコレクションで回収したものの数です
+ */
+struct gc_statistics {
+    /*! @brief 回収したノード (unique table のエントリ) の数 */
+    size_t nodes;
+    /*! @brief 削除した演算キャッシュのエントリの数 */
+    size_t cache_entries;
+    /*! @brief 再利用できるようになったインデックスの数 */
+    size_t indices;
+
+    gc_statistics() : nodes(0), cache_entries(0), indices(0) {}
+};
+
+/*!
+ * @brief std::shared_ptr で管理されるノードを格納するテーブルです
+ *
+ * ノードは個別にヒープへ確保され、参照カウントは std::shared_ptr が行います。
+ */
+template<class N>
+class basic_node_store {
+public:
+    /*! @brief このクラスが扱うノードの型 */
+    using node_type = N;
+    /*! @brief このクラスが扱うノードのポインタ型 */
+    using node_ptr = typename node_type::node_ptr;
+    /*! @brief 演算キャッシュに格納される型 */
+    using cache_ptr = std::weak_ptr<const node_type>;
+
+    /*! @brief 否定枝を用いるかどうか */
+    static constexpr bool complement_edges = false;
+    /*! @brief 複数のスレッドから同時に操作できるかどうか */
+    static constexpr bool concurrent = false;
+    /*! @brief 変数の順序を変更できるかどうか */
+    static constexpr bool reorderable = false;
+
+private:
+    using index_type = typename node_type::index_type;
+    using label_type = typename node_type::label_type;
+
+    /*!
+     * unique tableのスロットに格納される値です
+     *
+     * ノードが解放されてもインデックスはスロットに残り、
+     * 同じノードが再び生成されたときに再利用されます。
+     */
+    struct unique_entry {
+        index_type index;
+        cache_ptr node;
+    };
+
+    using unique_table_type = level_unique_table<label_type, index_type, unique_entry>;
+
+    /*!
+     * 解放されたノードの数を数える deleter です
+     *
+     * ノードがテーブルより長く生存しても良いように、カウンタは共有します。
+     */
+    struct counting_deleter {
+        std::shared_ptr<size_t> dead;
+        void operator()(const node_type* n) const {
+            ++*dead;
+            delete n;
+        }
+    };
+
+    const node_type __terminal_false, __terminal_true;
+    const node_ptr terminal_false, terminal_true;
+
+    unique_table_type unique_table;
+    index_type next_index;
+    std::vector<index_type> free_indices;
+    counting_deleter deleter;
+
+public:
+
+    /*!
+     * @brief コンストラクタ
+     */
+    basic_node_store() :
+            __terminal_false(0), __terminal_true(1),
+            terminal_false(&__terminal_false, null_deleter()),
+            terminal_true(&__terminal_true, null_deleter()),
+            next_index(2),
+            deleter{std::make_shared<size_t>(0)}
+    {}
+
+    /*! @brief コピーは禁止されています */
+    basic_node_store(const basic_node_store&) = delete;
+    /*! @brief 代入は禁止されています */
+    basic_node_store& operator=(const basic_node_store&) = delete;
+
+    /*!
+     * @brief 変数の順序における位置を返します
+     *
+     * 変数の順序は変更できないため、ラベルをそのまま返します。
+     */
+    const label_type& level(const label_type& l) const {return l;}
+
+    /*!
+     * @brief 0定節点を返します
+     */
+    const node_ptr& zero() const {return terminal_false;}
+    /*!
+     * @brief 1定節点を返します
+     */
+    const node_ptr& one() const {return terminal_true;}
+
+    /*!
+     * @brief ノード (l, t, e) を返します
+     *
+     * 既に存在する場合は既存のノードを返します。
+     * 節点削除規則はこのクラスでは適用しません。
+     */
+    const node_ptr make_node(const label_type& l, const node_ptr& t, const node_ptr& e) {
+        bool found;
+        unique_entry& entry = unique_table.lookup(l, t->index(), e->index(), found);
+        // もうすでに存在するなら既存のノードを返す
+        if (found) {
+            node_ptr n = entry.node.lock();
+            if (n) return n;
+        }
+        else if (free_indices.empty()) {
+            entry.index = next_index++;
+        }
+        else {
+            entry.index = free_indices.back();
+            free_indices.pop_back();
+        }
+        // 存在しなければ新しく生成
+        const node_ptr pf(new node_type(entry.index, l, t, e), deleter);
+        entry.node = pf; // 登録
+        return pf;
+    }
+
+    /*!
+     * @brief unique table のエントリの数を返します
+     */
+    size_t size() const {return unique_table.size();}
+
+    /*!
+     * @brief 解放されたノードの数を返します
+     *
+     * 前回のガベージコレクション以降に解放されたノードの数です。
+     */
+    size_t dead_count() const {return *deleter.dead;}
+
+    /*!
+     * @brief 解放されたノードのエントリを unique table から削除します
+     *
+     * 削除したエントリのインデックスは新しいノードに再利用されるため、
+     * 呼び出し側は演算キャッシュを全て破棄しなければなりません。
+     */
+    gc_statistics gc() {
+        gc_statistics s;
+        std::vector<index_type>& indices = free_indices;
+        s.nodes = unique_table.remove_if([&indices](const unique_entry& e) {
+            if (!e.node.expired()) return false;
+            indices.push_back(e.index);
+            return true;
+        });
+        s.indices = s.nodes;
+        *deleter.dead = 0;
+        return s;
+    }
+
+    /*!
+     * @brief 演算キャッシュからノードを取り出します
+     *
+     * @return ノードがまだ生存していれば true
+     */
+    bool load(const cache_ptr& c, node_ptr& n) const {
+        n = c.lock();
+        return n != nullptr;
+    }
+
+    /*!
+     * @brief 演算キャッシュに格納する値を生成します
+     */
+    cache_ptr save(const node_ptr& n) const {
+        return n;
+    }
+};
+
+template<class N>
+constexpr bool basic_node_store<N>::complement_edges;
+
+template<class N>
+constexpr bool basic_node_store<N>::concurrent;
+
+template<class N>
+constexpr bool basic_node_store<N>::reorderable;
+
+}
@@ -0,0 +1,203 @@
+#pragma once
+
+namespace boloq {
+
+/*!
+ * @brief 演算キャッシュの統計情報です
+ */
+struct operation_cache_statistics {
+    /*! @brief 検索の回数 */
+    size_t lookups;
+    /*! @brief 検索が成功した回数 */
+    size_t hits;
+    /*! @brief 登録の回数 */
+    size_t inserts;
+    /*! @brief 登録によって上書きされたエントリの数 */
+    size_t evictions;
+    /*! @brief エントリの数 */
+    size_t capacity;
+
+    operation_cache_statistics() :
+            lookups(0), hits(0), inserts(0), evictions(0), capacity(0)
+    {}
+
+    /*!
+     * @brief 統計情報を合算します
+     */
+    operation_cache_statistics& operator+=(const operation_cache_statistics& o) {
+        lookups += o.lookups;
+        hits += o.hits;
+        inserts += o.inserts;
+        evictions += o.evictions;
+        capacity += o.capacity;
+        return *this;
+    }
+};
+
+/*!
+ * @brief 大きさが固定された 2-way セットアソシエイティブの演算キャッシュです
+ *
+ * エントリ数は2の累乗で、衝突した場合は古いエントリを上書きします。
+ * そのため、プロセスの実行時間によらず使用するメモリは一定に保たれます。
+ *
+ * 自動拡張を有効にすると、エントリ数と同じ回数の登録を行うたびにヒット率を調べ、
+ * 閾値を上回っていれば上限に達するまでエントリ数を2倍にします。
+ */
+template<class K, class V>
+class operation_cache {
+public:
+    /*! @brief キーの型 */
+    using key_type = typename std::remove_const<K>::type;
+    /*! @brief 値の型 */
+    using value_type = V;
+
+private:
+    struct entry {
+        key_type key;
+        value_type value;
+        bool valid;
+    };
+
+    std::vector<entry> entries;
+    size_t mask;
+
+    size_t max_log2_size;
+    double min_hit_ratio;
+
+    operation_cache_statistics stats;
+    size_t window_lookups, window_hits, window_inserts;
+
+    std::hash<const key_type> hash_fn;
+
+    /*!
+     * キーに対応するセットの先頭のエントリを返します
+     */
+    size_t bucket(const key_type& key) const {
+        return (hash_fn(key) & mask) & ~size_t(1);
+    }
+
+    /*!
+     * ヒット率が十分高ければエントリ数を2倍にします
+     */
+    void adapt() {
+        if (window_inserts < entries.size()) return;
+        const bool grow = (entries.size() < (size_t(1) << max_log2_size)) &&
+            window_hits >= min_hit_ratio * window_lookups;
+        window_lookups = window_hits = window_inserts = 0;
+        if (grow) rehash(entries.size() * 2);
+    }
+
+    /*!
+     * エントリ数を変更して、保持しているエントリを再配置します
+     */
+    void rehash(const size_t n) {
+        std::vector<entry> old(n);
+        old.swap(entries);
+        mask = n - 1;
+        for (auto& e : old) {
+            if (e.valid) store(e.key, std::move(e.value));
+        }
+    }
+
+    void store(const key_type& key, value_type&& value) {
+        entry* set = &entries[bucket(key)];
+        if (!(set[0].valid && set[0].key == key)) {
+            if (set[1].valid) ++stats.evictions;
+            set[1] = std::move(set[0]);
+        }
+        set[0].key = key;
+        set[0].value = std::move(value);
+        set[0].valid = true;
+    }
+
+public:
+
+    /*!
+     * @brief コンストラクタ
+     *
+     * @param log2_size エントリ数の2を底とする対数
+     */
+    explicit operation_cache(const size_t log2_size = 12) :
+            max_log2_size(18), min_hit_ratio(0.3),
+            window_lookups(0), window_hits(0), window_inserts(0)
+    {
+        resize(log2_size);
+    }
+
+    /*!
+     * @brief キーに対応する値を検索します
+     *
+     * @return 見つかれば true
+     */
+    bool find(const key_type& key, value_type& value) {
+        ++stats.lookups;
+        ++window_lookups;
+        const entry* set = &entries[bucket(key)];
+        for (size_t i = 0; i < 2; i++) {
+            if (set[i].valid && set[i].key == key) {
+                ++stats.hits;
+                ++window_hits;
+                value = set[i].value;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /*!
+     * @brief 値を登録します
+     *
+     * 同じセットのエントリが埋まっていれば、古い方を上書きします。
+     */
+    void insert(const key_type& key, value_type value) {
+        ++stats.inserts;
+        ++window_inserts;
+        store(key, std::move(value));
+        adapt();
+    }
+
+    /*!
+     * @brief 全てのエントリを削除します
+     *
+     * @return 削除した有効なエントリの数
+     */
+    size_t clear() {
+        size_t n = 0;
+        for (auto& e : entries) {
+            if (e.valid) ++n;
+            e = entry();
+        }
+        return n;
+    }
+
+    /*!
+     * @brief エントリ数を変更します
+     *
+     * @param log2_size エントリ数の2を底とする対数 (1 以上)
+     */
+    void resize(const size_t log2_size) {
+        rehash(size_t(1) << std::max<size_t>(log2_size, 1));
+    }
+
+    /*!
+     * @brief 自動拡張の設定を変更します
+     *
+     * @param max_log2 エントリ数の上限の2を底とする対数。現在の大きさ以下なら自動拡張を行いません
+     * @param hit_ratio 拡張を行うヒット率の閾値
+     */
+    void set_auto_resize(const size_t max_log2, const double hit_ratio) {
+        max_log2_size = max_log2;
+        min_hit_ratio = hit_ratio;
+    }
+
+    /*!
+     * @brief 統計情報を返します
+     */
+    operation_cache_statistics statistics() const {
+        operation_cache_statistics s = stats;
+        s.capacity = entries.size();
+        return s;
+    }
+};
+
+}
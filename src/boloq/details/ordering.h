@@ -0,0 +1,220 @@
+#pragma once
+
+namespace boloq {
+
+/*!
+ * @brief 論理回路のゲートです
+ *
+ * 信号は整数で表し、0 から入力の数未満の信号を外部入力とします。
+ */
+struct netlist_gate {
+    /*! @brief ゲートの出力の信号 */
+    size_t output;
+    /*! @brief ゲートの入力の信号 */
+    std::vector<size_t> inputs;
+};
+
+/*!
+ * @brief 変数の順序からラベルの対応を求めます
+ *
+ * @param order 先頭から順に並べた変数
+ * @return 変数を添字とし、その変数に用いるラベルを値とする配列
+ */
+inline std::vector<size_t> labels_from_order(const std::vector<size_t>& order) {
+    std::vector<size_t> labels(order.size());
+    for (size_t i = 0; i < order.size(); i++) labels[order[i]] = i;
+    return labels;
+}
+
+/*!
+ * @brief 各辺が覆う範囲の合計を返します
+ *
+ * 辺 (節やゲート) に含まれる変数のラベルの最大値と最小値の差を全ての辺について合計します。
+ * 小さいほど関係する変数が近くに置かれています。
+ *
+ * @param edges 各辺に含まれる変数
+ * @param labels 変数を添字とするラベル
+ */
+inline size_t total_span(const std::vector<std::vector<size_t>>& edges, const std::vector<size_t>& labels) {
+    size_t span = 0;
+    for (const auto& e : edges) {
+        if (e.empty()) continue;
+        size_t lo = labels[e[0]], hi = lo;
+        for (const size_t v : e) {
+            lo = std::min(lo, labels[v]);
+            hi = std::max(hi, labels[v]);
+        }
+        span += hi - lo;
+    }
+    return span;
+}
+
+/*!
+ * @brief FORCE で変数の順序を求めます
+ *
+ * 各辺の重心を求め、各変数をその変数を含む辺の重心の平均の位置へ動かすことを繰り返します。
+ * 辺が覆う範囲の合計が減らなくなったら終了し、最も小さかった順序を返します。
+ *
+ * @param edges 各辺に含まれる変数
+ * @param variables 変数の数
+ * @param max_iterations 繰り返しの上限
+ * @return 変数を添字とするラベル
+ */
+inline std::vector<size_t> force_order(const std::vector<std::vector<size_t>>& edges,
+                                       const size_t variables, const size_t max_iterations = 64) {
+    std::vector<std::vector<size_t>> incident(variables);
+    for (size_t k = 0; k < edges.size(); k++) {
+        for (const size_t v : edges[k]) incident[v].push_back(k);
+    }
+
+    std::vector<size_t> order(variables);
+    for (size_t v = 0; v < variables; v++) order[v] = v;
+    std::vector<size_t> labels = labels_from_order(order), best = labels;
+    size_t best_span = total_span(edges, labels);
+
+    std::vector<double> cog(edges.size()), position(variables);
+    for (size_t it = 0; it < max_iterations; it++) {
+        for (size_t k = 0; k < edges.size(); k++) {
+            double sum = 0;
+            for (const size_t v : edges[k]) sum += labels[v];
+            cog[k] = edges[k].empty() ? 0 : sum / edges[k].size();
+        }
+        for (size_t v = 0; v < variables; v++) {
+            if (incident[v].empty()) {
+                position[v] = labels[v];
+                continue;
+            }
+            double sum = 0;
+            for (const size_t k : incident[v]) sum += cog[k];
+            position[v] = sum / incident[v].size();
+        }
+        std::stable_sort(order.begin(), order.end(), [&position](const size_t a, const size_t b) {
+            return position[a] < position[b];
+        });
+        labels = labels_from_order(order);
+        const size_t span = total_span(edges, labels);
+        if (span >= best_span) break;
+        best_span = span;
+        best = labels;
+    }
+    return best;
+}
+
+/*!
+ * @brief 範囲の小さい順序を貪欲に求めます
+ *
+ * 既に置いた変数と共有する辺が最も多い変数を次に置きます。
+ * 同じ数なら新たに開く辺が少ない変数を、それも同じなら番号の小さい変数を選びます。
+ * 関係する変数が近くに置かれるため、辺が覆う範囲の合計が小さくなります。
+ *
+ * @param edges 各辺に含まれる変数
+ * @param variables 変数の数
+ * @return 変数を添字とするラベル
+ */
+inline std::vector<size_t> min_span_order(const std::vector<std::vector<size_t>>& edges, const size_t variables) {
+    std::vector<std::vector<size_t>> incident(variables);
+    for (size_t k = 0; k < edges.size(); k++) {
+        for (const size_t v : edges[k]) incident[v].push_back(k);
+    }
+
+    // 各辺に置かれた変数の数
+    std::vector<size_t> placed_in(edges.size(), 0);
+    std::vector<bool> placed(variables, false);
+    std::vector<size_t> order;
+    order.reserve(variables);
+    while (order.size() < variables) {
+        size_t next = variables, best_shared = 0, best_opened = 0;
+        for (size_t v = 0; v < variables; v++) {
+            if (placed[v]) continue;
+            size_t shared = 0, opened = 0;
+            for (const size_t k : incident[v]) {
+                if (placed_in[k] > 0) ++shared;
+                else ++opened;
+            }
+            if (next == variables || shared > best_shared ||
+                    (shared == best_shared && opened < best_opened)) {
+                next = v;
+                best_shared = shared;
+                best_opened = opened;
+            }
+        }
+        placed[next] = true;
+        order.push_back(next);
+        for (const size_t k : incident[next]) ++placed_in[k];
+    }
+    return labels_from_order(order);
+}
+
+/*!
+ * @brief 論理回路の出力から深さ優先で辿った順序を求めます
+ *
+ * 出力から入力へ向かって辿り、外部入力に出会った順にラベルを割り当てます。
+ * 各ゲートでは入力側の論理段数が深い信号から先に辿ります。
+ * どの出力からも辿れない外部入力は最後に番号の順に置きます。
+ *
+ * @param gates ゲートの一覧
+ * @param outputs 外部出力の信号
+ * @param inputs 外部入力の数
+ * @return 外部入力を添字とするラベル
+ */
+inline std::vector<size_t> dfs_order(const std::vector<netlist_gate>& gates,
+                                     const std::vector<size_t>& outputs, const size_t inputs) {
+    std::unordered_map<size_t, const netlist_gate*> driver;
+    for (const auto& g : gates) driver[g.output] = &g;
+
+    // 各信号の論理段数を後順に求める
+    std::unordered_map<size_t, size_t> depth;
+    for (size_t s = 0; s < inputs; s++) depth[s] = 0;
+    std::vector<std::pair<size_t, bool>> stack;
+    for (const auto& g : gates) {
+        stack.emplace_back(g.output, false);
+        while (!stack.empty()) {
+            const size_t s = stack.back().first;
+            if (depth.count(s) || !driver.count(s)) {
+                if (!depth.count(s)) depth[s] = 0;
+                stack.pop_back();
+                continue;
+            }
+            if (!stack.back().second) {
+                stack.back().second = true;
+                for (const size_t i : driver[s]->inputs) stack.emplace_back(i, false);
+            }
+            else {
+                stack.pop_back();
+                size_t d = 0;
+                for (const size_t i : driver[s]->inputs) d = std::max(d, depth[i] + 1);
+                depth[s] = d;
+            }
+        }
+    }
+
+    std::vector<size_t> order;
+    std::vector<bool> visited_input(inputs, false);
+    std::unordered_map<size_t, bool> visited;
+    std::vector<size_t> work;
+    for (auto o = outputs.rbegin(); o != outputs.rend(); ++o) work.push_back(*o);
+    while (!work.empty()) {
+        const size_t s = work.back();
+        work.pop_back();
+        if (visited[s]) continue;
+        visited[s] = true;
+        if (s < inputs) {
+            visited_input[s] = true;
+            order.push_back(s);
+            continue;
+        }
+        if (!driver.count(s)) continue;
+        std::vector<size_t> fanin = driver[s]->inputs;
+        // 深い信号から辿るため、浅い信号から積む
+        std::stable_sort(fanin.begin(), fanin.end(), [&depth](const size_t a, const size_t b) {
+            return depth[a] < depth[b];
+        });
+        for (const size_t i : fanin) work.push_back(i);
+    }
+    for (size_t s = 0; s < inputs; s++) {
+        if (!visited_input[s]) order.push_back(s);
+    }
+    return labels_from_order(order);
+}
+
+}
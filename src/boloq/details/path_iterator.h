@@ -0,0 +1,137 @@
+#pragma once
+
+namespace boloq {
+
+/*!
+ * @brief 1-節点に至る経路を順に列挙する前方イテレータです
+ *
+ * 経路を明示的なスタックで深さ優先に辿り、経路を1つ進めるごとに1つの要素を返します。
+ * 要素は使い回されるため、列挙の途中で領域を確保することはありません。
+ * 要素は次に進めるまでの間だけ有効です。
+ *
+ * Sets が false の場合は論理関数を真にするキューブを、
+ * 経路上の変数とその値の組の列として返します。経路が飛ばした変数は任意の値を取れます。
+ * Sets が true の場合は組み合わせ集合の要素を、1枝を辿った変数の列として返します。
+ *
+ * 列挙の途中で変数の順序を変更してはいけません。
+ *
+ * @tparam T 論理関数または組み合わせ集合の型
+ * @tparam Sets 組み合わせ集合の要素を返すかどうか
+ */
+template<class T, bool Sets>
+class path_iterator {
+public:
+    /*! @brief ラベルの型 */
+    using label_type = typename T::label_type;
+    /*! @brief 要素の型 */
+    using value_type = typename std::conditional<Sets,
+          std::vector<label_type>,
+          std::vector<std::pair<label_type, bool>>>::type;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const value_type*;
+    using reference = const value_type&;
+    using iterator_category = std::forward_iterator_tag;
+
+private:
+    using self_type = path_iterator<T, Sets>;
+    using node_ptr = typename T::node_ptr;
+
+    /*!
+     * 経路上のノードと、次に辿る枝です
+     *
+     * branch は 0 なら1枝、1 なら0枝を次に辿り、2 なら両方を辿り終えたことを表します。
+     */
+    struct frame {
+        node_ptr node;
+        unsigned char branch;
+        bool pushed;
+    };
+
+    std::vector<frame> stack;
+    value_type current;
+    /*! 根が 1-節点で、空の経路を1つだけ返す状態 */
+    bool single;
+
+    static bool append(std::vector<label_type>& v, const label_type& l, const bool b) {
+        if (!b) return false;
+        v.push_back(l);
+        return true;
+    }
+
+    static bool append(std::vector<std::pair<label_type, bool>>& v, const label_type& l, const bool b) {
+        v.emplace_back(l, b);
+        return true;
+    }
+
+    /*!
+     * 次の 1-節点に至る経路まで進めます
+     */
+    void advance() {
+        while (!stack.empty()) {
+            frame& f = stack.back();
+            if (f.branch > 0 && f.pushed) current.pop_back();
+            if (f.branch == 2) {
+                stack.pop_back();
+                continue;
+            }
+            const bool positive = (f.branch == 0);
+            ++f.branch;
+            f.pushed = append(current, f.node->label(), positive);
+            const node_ptr c = positive ? f.node->then_node() : f.node->else_node();
+            if (c->is_terminal()) {
+                if (c->index()) return;
+                continue;
+            }
+            stack.push_back(frame{c, 0, false});
+        }
+    }
+
+public:
+
+    /*!
+     * @brief 終端を表すイテレータを生成します
+     */
+    path_iterator() : single(false) {}
+
+    /*!
+     * @brief ノードから1-節点に至る最初の経路を指すイテレータを生成します
+     */
+    explicit path_iterator(const node_ptr& n) : single(false) {
+        if (n->is_terminal()) {
+            single = (n->index() != 0);
+            return;
+        }
+        stack.push_back(frame{n, 0, false});
+        advance();
+    }
+
+    reference operator*() const {return current;}
+    pointer operator->() const {return &current;}
+
+    self_type& operator++() {
+        if (single) single = false;
+        else advance();
+        return *this;
+    }
+
+    self_type operator++(int) {
+        self_type r(*this);
+        ++*this;
+        return r;
+    }
+
+    /*!
+     * @brief 同じ経路を指していれば true を返します
+     */
+    bool operator==(const self_type& o) const {
+        if (single != o.single || stack.size() != o.stack.size()) return false;
+        for (size_t i = 0; i < stack.size(); i++) {
+            if (stack[i].node != o.stack[i].node || stack[i].branch != o.stack[i].branch) return false;
+        }
+        return true;
+    }
+
+    bool operator!=(const self_type& o) const {return !(*this == o);}
+};
+
+}
@@ -0,0 +1,142 @@
+#pragma once
+
+namespace boloq {
+
+/*!
+ * @brief 変数の順序の変更の結果です
+ */
+struct reorder_statistics {
+    /*! @brief 変更前のノードの数 */
+    size_t nodes_before;
+    /*! @brief 変更後のノードの数 */
+    size_t nodes_after;
+    /*! @brief 隣接する変数を入れ替えた回数 */
+    size_t swaps;
+
+    reorder_statistics() : nodes_before(0), nodes_after(0), swaps(0) {}
+};
+
+/*!
+ * @brief Rudell の sifting で変数の順序を変更します
+ *
+ * 変数を1つずつ全ての位置へ動かし、ノードの数が最小となる位置に置きます。
+ * 同じグループに属する変数は連続したブロックとして一緒に動かし、
+ * ブロックの中の順序は変えません。
+ *
+ * テーブルは level_count(), label_at(), level_size(), swap_levels(), size() を持つ必要があります。
+ * 位置はノードを生成したことのある変数にだけ割り当てられるため、
+ * ラベルの値が疎であっても、動かすのは実際に現れた変数だけです。
+ *
+ * @tparam S ノードを格納するテーブルの型
+ */
+template<class S>
+class variable_sifter {
+public:
+    /*! @brief ノードを格納するテーブルの型 */
+    using store_type = S;
+    /*! @brief ラベルの型 */
+    using label_type = typename store_type::node_type::label_type;
+
+private:
+    store_type& store;
+    /*! 各ブロックに属する変数の数と先頭の位置を、現在の順序で並べたもの */
+    std::vector<size_t> blocks, starts;
+    double max_growth;
+    reorder_statistics stats;
+
+    /*!
+     * k 番目と k + 1 番目のブロックを入れ替えます
+     */
+    void swap_blocks(const size_t k) {
+        const size_t s = starts[k], a = blocks[k], b = blocks[k + 1];
+        // 下のブロックの変数を上から順に、上のブロックを越えて持ち上げる
+        for (size_t j = 0; j < b; j++) {
+            for (size_t i = s + a + j; i-- > s + j;) {
+                store.swap_levels(i);
+                ++stats.swaps;
+            }
+        }
+        std::swap(blocks[k], blocks[k + 1]);
+        starts[k + 1] = s + blocks[k];
+    }
+
+    /*!
+     * k 番目のブロックを全ての位置へ動かし、最良の位置に置きます
+     */
+    void sift_block(size_t k) {
+        const size_t origin = k;
+        size_t best_size = store.size(), best_pos = k;
+        const size_t limit = static_cast<size_t>(best_size * max_growth);
+        // 下へ
+        while (k + 1 < blocks.size()) {
+            swap_blocks(k++);
+            if (store.size() < best_size) { best_size = store.size(); best_pos = k; }
+            else if (store.size() > limit) break;
+        }
+        // 上へ。元の位置までは同じ順序を通るため打ち切らない
+        while (k > 0) {
+            swap_blocks(--k);
+            if (store.size() < best_size) { best_size = store.size(); best_pos = k; }
+            else if (store.size() > limit && k < origin) break;
+        }
+        while (k < best_pos) swap_blocks(k++);
+        while (k > best_pos) swap_blocks(--k);
+    }
+
+public:
+
+    /*!
+     * @brief コンストラクタ
+     *
+     * @param s ノードを格納するテーブル
+     * @param group_of ラベルからグループの番号への対応。含まれない変数はどのグループにも属しません
+     * @param growth 移動中のノードの数がこの倍率を超えたら、その方向への移動をやめます
+     */
+    variable_sifter(store_type& s, const std::unordered_map<label_type, size_t>& group_of,
+                    const double growth = 1.2) :
+            store(s), max_growth(growth)
+    {
+        size_t last = 0;
+        for (size_t i = 0; i < store.level_count(); i++) {
+            const auto it = group_of.find(store.label_at(i));
+            const size_t g = (it != group_of.end()) ? it->second : 0;
+            if (g != 0 && g == last) {
+                ++blocks.back();
+            }
+            else {
+                starts.push_back(i);
+                blocks.push_back(1);
+            }
+            last = g;
+        }
+    }
+
+    /*!
+     * @brief 全てのブロックを sifting します
+     *
+     * ノードの多いブロックから順に動かします。
+     */
+    reorder_statistics run() {
+        stats.nodes_before = store.size();
+        // ブロックは入れ替わるため、先頭の変数のラベルで識別する
+        std::vector<std::pair<size_t, label_type>> order;
+        for (size_t k = 0; k < blocks.size(); k++) {
+            size_t n = 0;
+            for (size_t i = starts[k]; i < starts[k] + blocks[k]; i++) n += store.level_size(i);
+            if (n > 0) order.emplace_back(n, store.label_at(starts[k]));
+        }
+        std::stable_sort(order.begin(), order.end(),
+                [](const std::pair<size_t, label_type>& a, const std::pair<size_t, label_type>& b) {
+            return a.first > b.first;
+        });
+        for (const auto& o : order) {
+            size_t k = 0;
+            while (store.label_at(starts[k]) != o.second) k++;
+            sift_block(k);
+        }
+        stats.nodes_after = store.size();
+        return stats;
+    }
+};
+
+}
@@ -0,0 +1,283 @@
+#pragma once
+
+namespace boloq {
+
+/*!
+ * @brief 直列化した図の種類を表す文字です
+ */
+template<class F>
+struct diagram_kind;
+
+template<class T>
+struct diagram_kind<basic_boolean_function<T>> {
+    static constexpr char value = 'B';
+};
+
+template<class T>
+struct diagram_kind<basic_combination<T>> {
+    static constexpr char value = 'Z';
+};
+
+/*!
+ * @brief 直列化した図の検査に用いる FNV-1a ハッシュです
+ */
+class fnv1a_checksum {
+private:
+    uint64_t hash;
+
+public:
+    fnv1a_checksum() : hash(0xcbf29ce484222325ULL) {}
+
+    void update(const uint8_t b) {
+        hash = (hash ^ b) * 0x100000001b3ULL;
+    }
+
+    uint64_t value() const {return hash;}
+};
+
+/*!
+ * @brief 論理関数や組み合わせ集合を二進形式で書き出します
+ *
+ * 形式は次のとおりです。整数は全て LEB128 の可変長で表します。
+ *
+ * 1. "BOLQ", 版 (1), 種類 ('B' か 'Z') の 6 バイト
+ * 2. ノードの数、ブロックの数
+ * 3. 根から遠い変数から順に、変数ごとのブロック。
+ *    ラベル、ノードの数に続いて、各ノードの 1枝と 0枝の子を、
+ *    自身の番号から子の番号を引いた差で表します。
+ *    番号は 0 と 1 が定節点で、ノードには 2 から書き出した順に振ります
+ * 4. 根の数と、各根の番号
+ * 5. ここまでのバイト列の FNV-1a ハッシュ (8 バイト、リトルエンディアン)
+ *
+ * 子は必ず親より前に書き出されるため、読み込みは一度の走査で行えます。
+ * 複数の根が共有するノードは一度だけ書き出します。
+ *
+ * @tparam F 論理関数または組み合わせ集合の型
+ */
+template<class F>
+class diagram_writer {
+private:
+    using node_ptr = typename F::node_ptr;
+    using label_type = typename F::label_type;
+    using table_type = typename F::table_type;
+
+    struct root_visitor {
+        using result_type = node_ptr;
+        node_ptr operator()(const node_ptr& n) const {return n;}
+    };
+
+    std::ostream& os;
+    fnv1a_checksum checksum;
+
+    void put(const uint8_t b) {
+        os.put(static_cast<char>(b));
+        checksum.update(b);
+    }
+
+    void put_varint(uint64_t v) {
+        while (v >= 0x80) {
+            put(static_cast<uint8_t>(v | 0x80));
+            v >>= 7;
+        }
+        put(static_cast<uint8_t>(v));
+    }
+
+public:
+
+    /*!
+     * @brief コンストラクタ
+     */
+    explicit diagram_writer(std::ostream& o) : os(o) {}
+
+    /*!
+     * @brief 同じテーブルに属する図をまとめて書き出します
+     */
+    void write(const std::vector<F>& fs) {
+        std::vector<node_ptr> roots;
+        for (const auto& f : fs) {
+            if (&f.manager() != &fs[0].manager()) {
+                throw std::invalid_argument("boloq: diagrams belong to different managers");
+            }
+            roots.push_back(f.accept(root_visitor()));
+        }
+
+        // 全ての根から後順に辿る
+        node_scratch<uint64_t> ids;
+        ids.reset();
+        std::vector<node_ptr> order;
+        std::vector<std::pair<node_ptr, bool>> stack;
+        for (const auto& r : roots) {
+            if (!r->is_terminal()) stack.emplace_back(r, false);
+            while (!stack.empty()) {
+                const node_ptr m = stack.back().first;
+                if (ids.contains(static_cast<size_t>(m->index()))) {
+                    stack.pop_back();
+                    continue;
+                }
+                if (!stack.back().second) {
+                    stack.back().second = true;
+                    const node_ptr t = m->then_node(), e = m->else_node();
+                    if (!t->is_terminal()) stack.emplace_back(t, false);
+                    if (!e->is_terminal()) stack.emplace_back(e, false);
+                }
+                else {
+                    stack.pop_back();
+                    ids.set(static_cast<size_t>(m->index()), 0);
+                    order.push_back(m);
+                }
+            }
+        }
+
+        // 子は親より根から遠いため、根から遠い順に並べても子が先に来る
+        if (!fs.empty()) {
+            const table_type& t = fs[0].manager();
+            std::stable_sort(order.begin(), order.end(), [&t](const node_ptr& a, const node_ptr& b) {
+                return t.level(a->label()) > t.level(b->label());
+            });
+        }
+        size_t blocks = 0;
+        for (size_t k = 0; k < order.size(); k++) {
+            ids.set(static_cast<size_t>(order[k]->index()), k + 2);
+            if (k == 0 || order[k]->label() != order[k - 1]->label()) ++blocks;
+        }
+        const auto id = [&ids](const node_ptr& n) -> uint64_t {
+            if (n->is_terminal()) return n->index() ? 1 : 0;
+            return ids.get(static_cast<size_t>(n->index()));
+        };
+
+        for (const char c : {'B', 'O', 'L', 'Q'}) put(static_cast<uint8_t>(c));
+        put(1);
+        put(static_cast<uint8_t>(diagram_kind<F>::value));
+        put_varint(order.size());
+        put_varint(blocks);
+        for (size_t k = 0; k < order.size();) {
+            const label_type l = order[k]->label();
+            size_t end = k;
+            while (end < order.size() && order[end]->label() == l) end++;
+            put_varint(static_cast<uint64_t>(l));
+            put_varint(end - k);
+            for (; k < end; k++) {
+                put_varint(k + 2 - id(order[k]->then_node()));
+                put_varint(k + 2 - id(order[k]->else_node()));
+            }
+        }
+        put_varint(roots.size());
+        for (const auto& r : roots) put_varint(id(r));
+
+        const uint64_t h = checksum.value();
+        for (size_t i = 0; i < 8; i++) os.put(static_cast<char>(h >> (8 * i)));
+        if (!os) throw std::runtime_error("boloq: failed to write diagram");
+    }
+};
+
+/*!
+ * @brief diagram_writer が書き出した図を読み込みます
+ *
+ * ノードは子から順にユニークテーブルを通して生成するため、
+ * ノードの数に比例する時間で読み込めます。
+ * 読み込む先のテーブルは、書き出したときと同じ変数の順序でなければなりません。
+ * 形式が正しくない場合は std::runtime_error を送出します。
+ *
+ * @tparam F 論理関数または組み合わせ集合の型
+ */
+template<class F>
+class diagram_reader {
+private:
+    using node_ptr = typename F::node_ptr;
+    using label_type = typename F::label_type;
+    using table_type = typename F::table_type;
+
+    std::istream& is;
+    fnv1a_checksum checksum;
+
+    static void fail(const char* what) {
+        throw std::runtime_error(std::string("boloq: ") + what);
+    }
+
+    uint8_t get_raw() {
+        const auto c = is.get();
+        if (c == std::char_traits<char>::eof()) fail("unexpected end of diagram");
+        return static_cast<uint8_t>(c);
+    }
+
+    uint8_t get() {
+        const uint8_t b = get_raw();
+        checksum.update(b);
+        return b;
+    }
+
+    uint64_t get_varint() {
+        uint64_t v = 0;
+        for (size_t shift = 0;; shift += 7) {
+            if (shift > 63) fail("malformed integer in diagram");
+            const uint8_t b = get();
+            v |= static_cast<uint64_t>(b & 0x7f) << shift;
+            if (!(b & 0x80)) return v;
+        }
+    }
+
+public:
+
+    /*!
+     * @brief コンストラクタ
+     */
+    explicit diagram_reader(std::istream& i) : is(i) {}
+
+    /*!
+     * @brief 図を読み込み、テーブルに生成します
+     */
+    std::vector<F> read(table_type& t) {
+        for (const char c : {'B', 'O', 'L', 'Q'}) {
+            if (get() != static_cast<uint8_t>(c)) fail("not a diagram");
+        }
+        if (get() != 1) fail("unsupported diagram version");
+        if (get() != static_cast<uint8_t>(diagram_kind<F>::value)) fail("diagram kind mismatch");
+
+        const uint64_t count = get_varint();
+        const uint64_t blocks = get_varint();
+        std::vector<node_ptr> nodes;
+        nodes.push_back(t.zero());
+        nodes.push_back(t.one());
+        const auto child = [&](const label_type& l) -> node_ptr {
+            const uint64_t d = get_varint();
+            if (d == 0 || d > nodes.size()) fail("invalid child reference");
+            const node_ptr& c = nodes[nodes.size() - d];
+            if (!c->is_terminal() && t.level(c->label()) <= t.level(l)) {
+                fail("diagram does not respect the variable order");
+            }
+            return c;
+        };
+        for (uint64_t b = 0; b < blocks; b++) {
+            const uint64_t raw = get_varint();
+            const label_type l = static_cast<label_type>(raw);
+            if (static_cast<uint64_t>(l) != raw) fail("label out of range");
+            const uint64_t n = get_varint();
+            if (n > count - (nodes.size() - 2)) fail("node count mismatch");
+            for (uint64_t k = 0; k < n; k++) {
+                const node_ptr hi = child(l);
+                const node_ptr lo = child(l);
+                // BDD は両方の子が等しいノードを、ZDD は 1枝が 0-節点のノードを持たない
+                const bool redundant = (diagram_kind<F>::value == 'B') ? (hi == lo) : (hi == t.zero());
+                if (redundant) fail("unreduced node");
+                nodes.push_back(t.new_var(l, hi, lo));
+            }
+        }
+        if (nodes.size() - 2 != count) fail("node count mismatch");
+
+        const uint64_t roots = get_varint();
+        std::vector<F> result;
+        for (uint64_t r = 0; r < roots; r++) {
+            const uint64_t i = get_varint();
+            if (i >= nodes.size()) fail("invalid root reference");
+            result.push_back(F(t, nodes[i]));
+        }
+
+        const uint64_t h = checksum.value();
+        uint64_t stored = 0;
+        for (size_t i = 0; i < 8; i++) stored |= static_cast<uint64_t>(get_raw()) << (8 * i);
+        if (stored != h) fail("diagram checksum mismatch");
+        return result;
+    }
+};
+
+}
@@ -0,0 +1,312 @@
+#pragma once
+
+namespace boloq {
+
+/*!
+ * @brief unique tableの検索キーです
+ *
+ * 子ノードのインデックスの組をそのまま詰めて保持します。
+ * index_type が 32bit なら 64bit、64bit なら 128bit になります。
+ */
+template<class IT>
+struct unique_key {
+    /*! @brief 1枝側のノードのインデックス */
+    IT then_index;
+    /*! @brief 0枝側のノードのインデックス */
+    IT else_index;
+
+    /*!
+     * @brief 未使用のスロットを表すキーかどうかを返します
+     *
+     * 両方の子が同じ定節点であるノードは節点削除規則により存在しないため、
+     * (0, 0) を空のスロットの印として使います。
+     */
+    constexpr bool empty() const {return then_index == 0 && else_index == 0;}
+
+    constexpr bool operator==(const unique_key& o) const {
+        return then_index == o.then_index && else_index == o.else_index;
+    }
+
+    /*!
+     * @brief ハッシュ値を返します
+     */
+    uint64_t hash() const {
+        uint64_t h = uint64_t(then_index) * 0x9e3779b97f4a7c15ULL ^ uint64_t(else_index);
+        h ^= h >> 32;
+        h *= 0xd6e8feb86659fd93ULL;
+        h ^= h >> 32;
+        return h;
+    }
+};
+
+/*!
+ * @brief 1つの変数のためのオープンアドレス法のハッシュテーブルです
+ *
+ * キーと値をスロットに直接格納し、線形探索で衝突を解決します。
+ */
+template<class K, class V>
+class open_unique_table {
+public:
+    /*! @brief キーの型 */
+    using key_type = K;
+    /*! @brief 値の型 */
+    using value_type = V;
+
+private:
+    struct slot {
+        key_type key;
+        value_type value;
+    };
+
+    std::vector<slot> slots;
+    size_t _size;
+
+    /*!
+     * スロット数を2倍にして再配置します
+     */
+    void grow() {
+        std::vector<slot> old(slots.empty() ? 16 : slots.size() * 2);
+        old.swap(slots);
+        const size_t mask = slots.size() - 1;
+        for (auto& s : old) {
+            if (s.key.empty()) continue;
+            size_t i = s.key.hash() & mask;
+            while (!slots[i].key.empty()) i = (i + 1) & mask;
+            slots[i].key = s.key;
+            slots[i].value = std::move(s.value);
+        }
+    }
+
+public:
+
+    open_unique_table() : _size(0) {}
+
+    /*!
+     * @brief キーに対応する値を返します
+     *
+     * キーが存在しない場合は新しいスロットを確保し、found を false にします。
+     * その場合、呼び出し側が値を設定しなければなりません。
+     */
+    value_type& lookup(const key_type& key, bool& found) {
+        if ((_size + 1) * 10 > slots.size() * 7) grow();
+        const size_t mask = slots.size() - 1;
+        size_t i = key.hash() & mask;
+        while (!slots[i].key.empty()) {
+            if (slots[i].key == key) {
+                found = true;
+                return slots[i].value;
+            }
+            i = (i + 1) & mask;
+        }
+        found = false;
+        ++_size;
+        slots[i].key = key;
+        return slots[i].value;
+    }
+
+    /*!
+     * @brief キーを削除します
+     *
+     * 後続のスロットを詰め直すため、削除の印は残りません。
+     *
+     * @return 削除できれば true
+     */
+    bool erase(const key_type& key) {
+        if (slots.empty()) return false;
+        const size_t mask = slots.size() - 1;
+        size_t i = key.hash() & mask;
+        while (!(slots[i].key == key)) {
+            if (slots[i].key.empty()) return false;
+            i = (i + 1) & mask;
+        }
+        for (size_t j = (i + 1) & mask; !slots[j].key.empty(); j = (j + 1) & mask) {
+            const size_t k = slots[j].key.hash() & mask;
+            // k が (i, j] の外にあるスロットだけを i に詰められる
+            const bool movable = (i <= j) ? (k <= i || j < k) : (k <= i && j < k);
+            if (movable) {
+                slots[i] = std::move(slots[j]);
+                i = j;
+            }
+        }
+        slots[i] = slot();
+        --_size;
+        return true;
+    }
+
+    /*!
+     * @brief 条件を満たす値を全て削除します
+     *
+     * @param pred 値を受け取り、削除するなら true を返す関数
+     * @return 削除した数
+     */
+    template<class Pred>
+    size_t remove_if(Pred pred) {
+        std::vector<slot> old(slots.size());
+        old.swap(slots);
+        const size_t mask = slots.size() - 1;
+        size_t removed = 0;
+        for (auto& s : old) {
+            if (s.key.empty()) continue;
+            if (pred(s.value)) {
+                ++removed;
+                continue;
+            }
+            size_t i = s.key.hash() & mask;
+            while (!slots[i].key.empty()) i = (i + 1) & mask;
+            slots[i].key = s.key;
+            slots[i].value = std::move(s.value);
+        }
+        _size -= removed;
+        return removed;
+    }
+
+    /*!
+     * @brief 登録されている全てのキーと値に関数を適用します
+     *
+     * 関数の中でこのテーブルを変更してはいけません。
+     */
+    template<class F>
+    void for_each(F f) const {
+        for (const auto& s : slots) {
+            if (!s.key.empty()) f(s.key, s.value);
+        }
+    }
+
+    /*!
+     * @brief 登録されているキーの数を返します
+     */
+    size_t size() const {return _size;}
+
+    /*!
+     * @brief 確保されているスロットの数を返します
+     */
+    size_t capacity() const {return slots.size();}
+};
+
+/*!
+ * @brief 変数ごとに分割されたunique tableです
+ *
+ * 変数のラベルで分割するため、キーにラベルを含める必要がありません。
+ * 変数のテーブルは初めて現れた順に密な添字で並べ、ラベルから添字への対応は別に保持します。
+ * そのため、ラベルの値が大きくても疎であっても、現れた変数の数だけのテーブルしか確保しません。
+ */
+template<class LT, class IT, class V>
+class level_unique_table {
+public:
+    /*! @brief ラベルの型 */
+    using label_type = LT;
+    /*! @brief キーの型 */
+    using key_type = unique_key<IT>;
+    /*! @brief 変数ごとのテーブルの型 */
+    using table_type = open_unique_table<key_type, V>;
+
+private:
+    std::vector<table_type> tables;
+    std::vector<label_type> labels;
+    std::unordered_map<label_type, size_t> slots;
+    size_t _size;
+
+    /*! 直前に参照した変数。同じ変数のノードは続けて生成されることが多い */
+    label_type last_label;
+    size_t last_slot;
+
+public:
+    /*! @brief 存在しない変数を表す添字 */
+    static constexpr size_t npos = std::numeric_limits<size_t>::max();
+
+    level_unique_table() : _size(0), last_label(), last_slot(0) {}
+
+    /*!
+     * @brief 変数のテーブルの添字を返します
+     *
+     * 添字は label(i) の i であり、テーブルが無ければ npos を返します。
+     */
+    size_t slot(const label_type& l) const {
+        if (!tables.empty() && l == last_label) return last_slot;
+        const auto it = slots.find(l);
+        return (it != slots.end()) ? it->second : npos;
+    }
+
+    /*!
+     * @brief 変数に対応するテーブルを返します
+     *
+     * 初めて現れた変数であれば、新しいテーブルを登録します。
+     * 返した参照は、次に新しい変数を登録するまで有効です。
+     */
+    table_type& level(const label_type& l) {
+        size_t i = slot(l);
+        if (i == npos) {
+            i = tables.size();
+            slots.emplace(l, i);
+            tables.emplace_back();
+            labels.push_back(l);
+        }
+        last_label = l;
+        last_slot = i;
+        return tables[i];
+    }
+
+    /*!
+     * @brief ノード (l, t, e) に対応する値を返します
+     *
+     * @sa open_unique_table::lookup
+     */
+    V& lookup(const label_type& l, const IT& t, const IT& e, bool& found) {
+        V& v = level(l).lookup(key_type{t, e}, found);
+        if (!found) ++_size;
+        return v;
+    }
+
+    /*!
+     * @brief ノード (l, t, e) を削除します
+     */
+    bool erase(const label_type& l, const IT& t, const IT& e) {
+        const size_t i = slot(l);
+        if (i == npos || !tables[i].erase(key_type{t, e})) return false;
+        --_size;
+        return true;
+    }
+
+    /*!
+     * @brief 条件を満たす値を全ての変数のテーブルから削除します
+     *
+     * @sa open_unique_table::remove_if
+     */
+    template<class Pred>
+    size_t remove_if(Pred pred) {
+        size_t n = 0;
+        for (auto& t : tables) n += t.remove_if(pred);
+        _size -= n;
+        return n;
+    }
+
+    /*!
+     * @brief 登録されているノードの数を返します
+     */
+    size_t size() const {return _size;}
+
+    /*!
+     * @brief 変数に登録されているノードの数を返します
+     */
+    size_t size(const label_type& l) const {
+        const size_t i = slot(l);
+        return (i != npos) ? tables[i].size() : 0;
+    }
+
+    /*!
+     * @brief テーブルを確保した変数の数を返します
+     */
+    size_t label_count() const {return labels.size();}
+
+    /*!
+     * @brief i 番目にテーブルを確保した変数のラベルを返します
+     *
+     * 変数は初めて現れた順に並び、以後その順は変わりません。
+     */
+    const label_type& label(const size_t i) const {return labels[i];}
+};
+
+template<class LT, class IT, class V>
+constexpr size_t level_unique_table<LT, IT, V>::npos;
+
+}
@@ -2,30 +2,400 @@
 
 namespace boloq {
 
-template<class T, class UIntT>
+/*!
+ * @brief 2 を底とする対数で表した数です
+ *
+ * 倍精度浮動小数点数でも溢れるような大きな数を近似的に数えるのに用います。
+ */
+struct log2_count {
+    /*! @brief 数の2を底とする対数。0 は負の無限大で表します */
+    double value;
+
+    /*! @brief 数を返します */
+    double count() const {return std::exp2(value);}
+};
+
+/*!
+ * @brief 任意の桁数の符号なし整数です
+ *
+ * 数え上げの結果に必要な、加算と2の冪の乗算だけを持ちます。
+ */
+class big_uint {
+private:
+    /*! 下位の桁から並べた 32bit の桁 */
+    std::vector<uint32_t> limbs;
+
+    void trim() {
+        while (!limbs.empty() && limbs.back() == 0) limbs.pop_back();
+    }
+
+public:
+
+    /*!
+     * @brief コンストラクタ
+     */
+    big_uint(uint64_t v = 0) {
+        while (v != 0) {
+            limbs.push_back(static_cast<uint32_t>(v));
+            v >>= 32;
+        }
+    }
+
+    big_uint operator+(const big_uint& o) const {
+        big_uint r;
+        r.limbs.resize(std::max(limbs.size(), o.limbs.size()) + 1, 0);
+        uint64_t carry = 0;
+        for (size_t i = 0; i + 1 < r.limbs.size(); i++) {
+            carry += (i < limbs.size() ? limbs[i] : 0);
+            carry += (i < o.limbs.size() ? o.limbs[i] : 0);
+            r.limbs[i] = static_cast<uint32_t>(carry);
+            carry >>= 32;
+        }
+        r.limbs.back() = static_cast<uint32_t>(carry);
+        r.trim();
+        return r;
+    }
+
+    /*!
+     * @brief 2^k 倍した値を返します
+     */
+    big_uint operator<<(const size_t k) const {
+        if (limbs.empty()) return *this;
+        big_uint r;
+        const size_t words = k / 32, bits = k % 32;
+        r.limbs.assign(words, 0);
+        uint32_t carry = 0;
+        for (const uint32_t l : limbs) {
+            r.limbs.push_back((l << bits) | carry);
+            carry = bits ? (l >> (32 - bits)) : 0;
+        }
+        r.limbs.push_back(carry);
+        r.trim();
+        return r;
+    }
+
+    bool operator==(const big_uint& o) const {return limbs == o.limbs;}
+    bool operator!=(const big_uint& o) const {return limbs != o.limbs;}
+
+    /*!
+     * @brief 10 進数の文字列を返します
+     */
+    std::string to_string() const {
+        if (limbs.empty()) return "0";
+        std::vector<uint32_t> n(limbs);
+        std::vector<uint32_t> chunks;
+        // 10^9 で割った余りを下位から求める
+        while (!n.empty()) {
+            uint64_t rem = 0;
+            for (size_t i = n.size(); i-- > 0;) {
+                const uint64_t cur = (rem << 32) | n[i];
+                n[i] = static_cast<uint32_t>(cur / 1000000000);
+                rem = cur % 1000000000;
+            }
+            chunks.push_back(static_cast<uint32_t>(rem));
+            while (!n.empty() && n.back() == 0) n.pop_back();
+        }
+        std::string s = std::to_string(chunks.back());
+        for (size_t i = chunks.size() - 1; i-- > 0;) {
+            const std::string c = std::to_string(chunks[i]);
+            s += std::string(9 - c.size(), '0') + c;
+        }
+        return s;
+    }
+};
+
+/*!
+ * @brief 数え上げの結果の型に対する演算です
+ *
+ * 既定では 0 と 1 から構築でき、+ と << (2^k 倍) を持つ型を扱います。
+ * uint64_t や unsigned __int128、big_uint などが利用できます。
+ * 整数型では結果が溢れないように呼び出し側が注意しなければなりません。
+ */
+template<class R>
+struct count_traits {
+    static R zero() {return R(0);}
+    static R one() {return R(1);}
+    static R add(const R& a, const R& b) {return a + b;}
+    static R shift(const R& a, const size_t k) {return a << k;}
+};
+
+/*!
+ * @brief 浮動小数点数で近似的に数えます
+ */
+template<>
+struct count_traits<double> {
+    static double zero() {return 0.0;}
+    static double one() {return 1.0;}
+    static double add(const double& a, const double& b) {return a + b;}
+    static double shift(const double& a, const size_t k) {return std::ldexp(a, static_cast<int>(k));}
+};
+
+/*!
+ * @brief 対数で近似的に数えます
+ */
+template<>
+struct count_traits<log2_count> {
+    static log2_count zero() {return log2_count{-std::numeric_limits<double>::infinity()};}
+    static log2_count one() {return log2_count{0.0};}
+    static log2_count add(const log2_count& a, const log2_count& b) {
+        const double m = std::max(a.value, b.value);
+        if (m == -std::numeric_limits<double>::infinity()) return a;
+        return log2_count{m + std::log2(std::exp2(a.value - m) + std::exp2(b.value - m))};
+    }
+    static log2_count shift(const log2_count& a, const size_t k) {
+        return log2_count{a.value + static_cast<double>(k)};
+    }
+};
+
+/*!
+ * @brief ノードのインデックスを添字とする作業領域です
+ *
+ * 世代の番号で有効な値を区別するため、呼び出しごとの初期化は O(1) で行えます。
+ */
+template<class R>
+class node_scratch {
+private:
+    std::vector<R> values;
+    std::vector<size_t> stamps;
+    size_t generation;
+
+public:
+
+    node_scratch() : generation(0) {}
+
+    /*!
+     * @brief 全ての値を無効にします
+     */
+    void reset() {++generation;}
+
+    /*!
+     * @brief インデックスの値が有効かどうかを返します
+     */
+    bool contains(const size_t i) const {
+        return i < stamps.size() && stamps[i] == generation;
+    }
+
+    /*!
+     * @brief インデックスの値を返します
+     */
+    const R& get(const size_t i) const {return values[i];}
+
+    /*!
+     * @brief インデックスに値を設定します
+     */
+    void set(const size_t i, const R& v) {
+        if (i >= stamps.size()) {
+            const size_t n = std::max(i + 1, stamps.size() * 2);
+            stamps.resize(n, 0);
+            values.resize(n, v);
+        }
+        values[i] = v;
+        stamps[i] = generation;
+    }
+};
+
+/*!
+ * @brief 組み合わせ集合の要素数 (1-節点に至る経路の数) を数える visitor です
+ *
+ * @tparam T 組み合わせ集合の型
+ * @tparam R 結果の型
+ */
+template<class T, class R>
 class count_visitor {
 public:
-    using result_type = UIntT;
+    using result_type = R;
 
 private:
     /*! @brief このクラスが扱うノードの型 */
     using node_ptr = typename T::node_ptr;
+    using traits = count_traits<result_type>;
+
+    node_scratch<result_type> scratch;
+
+    /*!
+     * 定節点か数え終わったノードの値を返します
+     */
+    result_type value(const node_ptr& n) const {
+        if (n->is_terminal()) return n->index() ? traits::one() : traits::zero();
+        return scratch.get(static_cast<size_t>(n->index()));
+    }
 
-    std::unordered_map<node_ptr, result_type> count_cache;
 public:
 
+    /*!
+     * @brief ノードが表す集合の要素数を返します
+     *
+     * 子を先に数える必要があるため、ヒープ上のスタックで後順に辿ります。
+     */
     result_type operator()(const node_ptr& n) {
-        if (n->is_terminal()) {
-            if (n->index()) return result_type(1);
-            else return result_type(0);
+        if (n->is_terminal()) return value(n);
+
+        scratch.reset();
+        std::vector<std::pair<node_ptr, bool>> stack;
+        stack.emplace_back(n, false);
+        while (!stack.empty()) {
+            const node_ptr m = stack.back().first;
+            if (scratch.contains(static_cast<size_t>(m->index()))) {
+                stack.pop_back();
+                continue;
+            }
+            if (!stack.back().second) {
+                stack.back().second = true;
+                const node_ptr t = m->then_node(), e = m->else_node();
+                if (!t->is_terminal()) stack.emplace_back(t, false);
+                if (!e->is_terminal()) stack.emplace_back(e, false);
+            }
+            else {
+                stack.pop_back();
+                scratch.set(static_cast<size_t>(m->index()),
+                            traits::add(value(m->then_node()), value(m->else_node())));
+            }
         }
+        return value(n);
+    }
 
-        const auto it = count_cache.find(n);
-        if (it != count_cache.end()) return it->second;
+};
 
-        result_type r = operator()(n->then_node()) + operator()(n->else_node());
-        count_cache[n] = r;
-        return r;
+/*!
+ * @brief 定節点を除いたノードの数を数える visitor です
+ *
+ * 否定枝を用いる場合、同じノードを正負どちらの枝から参照しても 1 つと数えます。
+ *
+ * @tparam T 論理関数または組み合わせ集合の型
+ */
+template<class T>
+class node_count_visitor {
+public:
+    using result_type = size_t;
+
+private:
+    using node_ptr = typename T::node_ptr;
+
+    static constexpr bool complement = T::table_type::node_type::store_type::complement_edges;
+
+    node_scratch<bool> visited;
+
+    /*!
+     * ハンドルから否定のビットを除いたノードの番号を返します
+     */
+    static size_t id_of(const node_ptr& n) {
+        const size_t i = static_cast<size_t>(n->index());
+        return complement ? i >> 1 : i;
+    }
+
+public:
+
+    /*!
+     * @brief ノードから辿れるノードの数を返します
+     */
+    result_type operator()(const node_ptr& n) {
+        visited.reset();
+        size_t count = 0;
+        std::vector<node_ptr> stack;
+        if (!n->is_terminal()) stack.push_back(n);
+        while (!stack.empty()) {
+            const node_ptr m = stack.back();
+            stack.pop_back();
+            if (visited.contains(id_of(m))) continue;
+            visited.set(id_of(m), true);
+            ++count;
+            const node_ptr t = m->then_node(), e = m->else_node();
+            if (!t->is_terminal()) stack.push_back(t);
+            if (!e->is_terminal()) stack.push_back(e);
+        }
+        return count;
+    }
+
+};
+
+template<class T>
+constexpr bool node_count_visitor<T>::complement;
+
+/*!
+ * @brief 論理関数を真にする割り当ての数を数える visitor です
+ *
+ * 変数の順序で位置 0 から nvars - 1 の変数についての割り当てを数えます。
+ * 枝が飛ばした変数は任意の値を取れるため、飛ばした数を k として 2^k 倍します。
+ *
+ * @tparam T 論理関数の型
+ * @tparam R 結果の型
+ */
+template<class T, class R>
+class satcount_visitor {
+public:
+    using result_type = R;
+
+private:
+    using node_ptr = typename T::node_ptr;
+    using table_type = typename T::table_type;
+    using traits = count_traits<result_type>;
+
+    const table_type& table;
+    const size_t nvars;
+    node_scratch<result_type> scratch;
+
+    /*!
+     * ノードの変数の位置を返します。定節点は nvars です
+     */
+    size_t level(const node_ptr& n) const {
+        if (n->is_terminal()) return nvars;
+        const size_t l = static_cast<size_t>(table.level(n->label()));
+        if (l >= nvars) throw std::invalid_argument("boloq: variable out of range for satcount");
+        return l;
+    }
+
+    /*!
+     * ノードの変数以降の変数についての割り当ての数を返します
+     */
+    result_type value(const node_ptr& n) const {
+        if (n->is_terminal()) return n->index() ? traits::one() : traits::zero();
+        return scratch.get(static_cast<size_t>(n->index()));
+    }
+
+    /*!
+     * 子の値を、親から子までに飛ばした変数の分だけ倍にします
+     */
+    result_type edge(const size_t parent, const node_ptr& child) const {
+        return traits::shift(value(child), level(child) - parent - 1);
+    }
+
+public:
+
+    /*!
+     * @brief コンストラクタ
+     *
+     * @param t 論理関数が属するテーブル
+     * @param n 変数の数
+     */
+    satcount_visitor(const table_type& t, const size_t n) : table(t), nvars(n) {}
+
+    /*!
+     * @brief ノードが表す論理関数を真にする割り当ての数を返します
+     */
+    result_type operator()(const node_ptr& n) {
+        scratch.reset();
+        std::vector<std::pair<node_ptr, bool>> stack;
+        if (!n->is_terminal()) stack.emplace_back(n, false);
+        while (!stack.empty()) {
+            const node_ptr m = stack.back().first;
+            if (scratch.contains(static_cast<size_t>(m->index()))) {
+                stack.pop_back();
+                continue;
+            }
+            if (!stack.back().second) {
+                stack.back().second = true;
+                const node_ptr t = m->then_node(), e = m->else_node();
+                if (!t->is_terminal()) stack.emplace_back(t, false);
+                if (!e->is_terminal()) stack.emplace_back(e, false);
+            }
+            else {
+                stack.pop_back();
+                const size_t l = level(m);
+                scratch.set(static_cast<size_t>(m->index()),
+                            traits::add(edge(l, m->then_node()), edge(l, m->else_node())));
+            }
+        }
+        return traits::shift(value(n), level(n));
     }
 
 };
@@ -23,15 +23,14 @@ public:
     explicit execute_visitor(const assign_type& a) : _assign(a) {}
 
     /*!
-     * @brief ノードを評価して、子を再帰的に呼び出します
+     * @brief ノードを評価して、定節点に達するまで子を辿ります
      */
     bool operator()(const node_ptr& n) const {
-        if (n->is_terminal()) {
-            return n->index();
+        node_ptr m = n;
+        while (!m->is_terminal()) {
+            m = (_assign.at(m->label())) ? m->then_node() : m->else_node();
         }
-        const node_ptr& next = (_assign.at(n->label())) ?
-            n->then_node() : n->else_node();
-        return next->accept(*this);
+        return m->index();
     }
 };
 
@@ -55,21 +54,23 @@ public:
     explicit execute_visitor(const assign_type* a) : _assign(a) {}
 
     /*!
-     * @brief ノードを評価して、子を再帰的に呼び出します
+     * @brief ノードを評価して、定節点に達するまで子を辿ります
      */
     bool operator()(const node_ptr& n) const {
-        if (n->is_terminal()) {
-            return n->index();
+        node_ptr m = n;
+        while (!m->is_terminal()) {
+            m = (_assign[m->label()]) ? m->then_node() : m->else_node();
         }
-        const node_ptr& next = (_assign[n->label()]) ?
-            n->then_node() : n->else_node();
-        return next->accept(*this);
+        return m->index();
     }
 
 };
 
 /*!
  * @brief 組み合わせ集合を評価するためのvisitorです
+ *
+ * 割り当てはアイテムのラベルと、そのアイテムを集合に含むかどうかの組です。
+ * 割り当てに現れないアイテムは、順序の上でどこにあっても集合に含まれないものとして扱います。
  */
 template<class T, class AssignT>
 class contain_visitor {
@@ -89,26 +90,33 @@ public:
     explicit contain_visitor(const assign_type& a) : _assign(a.begin(), a.end()) {}
 
     /*!
-     * @brief ノードを評価して、子を再帰的に呼び出します
+     * @brief ノードを評価して、定節点に達するまで子を辿ります
      */
     bool operator()(const node_ptr& n) {
-        if (_assign.empty() && n->is_terminal()) {
-            return n->index();
-        }
-
-        if (n->label() == _assign.top().first) {
-            auto& next = (_assign.top().second) ? n->then_node() : n->else_node();
-            _assign.pop();
-            return next->accept(*this);
-        }
-        else if (n->label() > _assign.top().first) {
-            if (_assign.top().second) {
-                return false;
+        node_ptr m = n;
+        while (!m->is_terminal()) {
+            // 割り当てに現れないアイテムは含まれない
+            if (_assign.empty() || m->label() < _assign.top().first) {
+                m = m->else_node();
             }
+            else if (m->label() == _assign.top().first) {
+                m = (_assign.top().second) ? m->then_node() : m->else_node();
+                _assign.pop();
+            }
+            else {
+                // ノードの無いアイテムを含む集合は要素ではない
+                if (_assign.top().second) {
+                    return false;
+                }
+                _assign.pop();
+            }
+        }
+        // 定節点より後のアイテムを含むなら要素ではない
+        while (!_assign.empty()) {
+            if (_assign.top().second) return false;
             _assign.pop();
-            return n->accept(*this);
         }
-        return false;
+        return m->index();
     }
 
 };
@@ -41,13 +41,16 @@ class is_conjunction_visitor : public __function_type_visitor<T> {
     using node_ptr = typename T::node_ptr;
 public:
     bool operator()(const node_ptr& n) const {
-        if (n->else_node()->index() != 0 || n->then_node()->index() == 0) {
-            return false;
-        }
-        if (n->then_node()->index() == 1) {
-            return true;
+        node_ptr m = n;
+        while (true) {
+            if (m->else_node()->index() != 0 || m->then_node()->index() == 0) {
+                return false;
+            }
+            if (m->then_node()->index() == 1) {
+                return true;
+            }
+            m = m->then_node();
         }
-        return operator()(n->then_node());
     }
 };
 
@@ -59,13 +62,16 @@ class is_disjunction_visitor : public __function_type_visitor<T> {
     using node_ptr = typename T::node_ptr;
 public:
     bool operator()(const node_ptr& n) const {
-        if (n->then_node()->index() != 1 || n->else_node()->index() == 1) {
-            return false;
-        }
-        if (n->else_node()->index() == 0) {
-            return true;
+        node_ptr m = n;
+        while (true) {
+            if (m->then_node()->index() != 1 || m->else_node()->index() == 1) {
+                return false;
+            }
+            if (m->else_node()->index() == 0) {
+                return true;
+            }
+            m = m->else_node();
         }
-        return operator()(n->else_node());
     }
 };
 
@@ -75,20 +81,28 @@ public:
 template<class T>
 class is_exclusive_disjunction_visitor : public __function_type_visitor<T> {
     using node_ptr = typename T::node_ptr;
+    using table_type = typename T::table_type;
+
+    table_type& table;
 public:
+    explicit is_exclusive_disjunction_visitor(table_type& t) : table(t) {}
+
     bool operator()(const node_ptr& n) const {
         if (n->is_terminal()) {
             return false;
         }
 
-        const auto& next_then = n->then_node();
-        if (T(next_then) != ~T(n->else_node())) {
-            return false;
-        }
-        else if (next_then->is_terminal()) {
-            return true;
+        node_ptr m = n;
+        while (true) {
+            const node_ptr next_then = m->then_node();
+            if (T(table, next_then) != ~T(table, m->else_node())) {
+                return false;
+            }
+            else if (next_then->is_terminal()) {
+                return true;
+            }
+            m = next_then;
         }
-        return operator()(next_then);
     }
 };
 
@@ -26,19 +26,29 @@ public:
     {}
 
     /*!
-     * @brief ノードを表示して、子を再帰的に呼び出します
+     * @brief ノードを表示して、子を順に表示します
+     *
+     * 深さ優先で辿るためのスタックはヒープ上に確保されます。
+     * 共有された部分は辿るたびに表示されるため、大きな図には diagram_exporter を用いてください。
      */
     result_type operator()(const node_ptr& n) {
-        for (unsigned int i = 0; i < indent_level; i++) {
-            ost << '\t';
-        }
-        ost << n->label() << ' ' << n->index() << std::endl;
-
-        if (!n->is_terminal()) {
-            indent_level++;
-            n->then_node()->accept(*this);
-            n->else_node()->accept(*this);
-            indent_level--;
+        std::vector<std::pair<node_ptr, unsigned int>> stack;
+        stack.emplace_back(n, indent_level);
+        while (!stack.empty()) {
+            const node_ptr m = stack.back().first;
+            const unsigned int level = stack.back().second;
+            stack.pop_back();
+
+            for (unsigned int i = 0; i < level; i++) {
+                ost << '\t';
+            }
+            ost << m->label() << ' ' << m->index() << '\n';
+
+            if (!m->is_terminal()) {
+                // then 側を先に表示するため、else 側から積む
+                stack.emplace_back(m->else_node(), level + 1);
+                stack.emplace_back(m->then_node(), level + 1);
+            }
         }
 
         return ost;
@@ -0,0 +1,209 @@
+#pragma once
+
+namespace boloq {
+
+/*!
+ * @brief 分割統治のためのワークスティーリング型スレッドプールです
+ *
+ * 各スレッドは自分のキューの末尾にタスクを積み、末尾から取り出して実行します。
+ * 自分のキューが空になったスレッドは、他のスレッドのキューの先頭からタスクを盗みます。
+ * プールに属さないスレッドから呼び出した場合は、共有のキューを用います。
+ *
+ * タスクの完了を待つスレッドは、待っている間も他のタスクを実行します。
+ */
+class work_stealing_pool {
+private:
+    struct task {
+        std::function<void()> fn;
+        std::atomic<bool> done;
+        std::exception_ptr error;
+
+        void run() {
+            try {
+                fn();
+            }
+            catch (...) {
+                error = std::current_exception();
+            }
+            done.store(true, std::memory_order_release);
+        }
+    };
+
+    struct worker_queue {
+        std::mutex mutex;
+        std::deque<task*> tasks;
+    };
+
+    /*! queues[0] はプールに属さないスレッドが共有します */
+    std::vector<std::unique_ptr<worker_queue>> queues;
+    std::vector<std::thread> threads;
+    std::atomic<bool> stopping;
+    std::atomic<size_t> pending;
+    std::mutex idle_mutex;
+    std::condition_variable idle;
+
+    /*!
+     * 現在のスレッドが属するプールとキューの番号です
+     */
+    struct worker_id {
+        const work_stealing_pool* pool;
+        size_t queue;
+    };
+
+    static worker_id& current() {
+        static thread_local worker_id id{nullptr, 0};
+        return id;
+    }
+
+    size_t own_queue() const {
+        return (current().pool == this) ? current().queue : 0;
+    }
+
+    void push(const size_t q, task* t) {
+        {
+            std::lock_guard<std::mutex> lock(queues[q]->mutex);
+            queues[q]->tasks.push_back(t);
+        }
+        pending.fetch_add(1, std::memory_order_release);
+        idle.notify_one();
+    }
+
+    /*!
+     * 自分のキューの末尾が t であれば取り出します
+     */
+    bool pop_if(const size_t q, task* t) {
+        std::lock_guard<std::mutex> lock(queues[q]->mutex);
+        auto& d = queues[q]->tasks;
+        if (d.empty() || d.back() != t) return false;
+        d.pop_back();
+        pending.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    /*!
+     * 実行できるタスクを1つ取り出します
+     *
+     * 自分のキューの末尾を優先し、空であれば他のキューの先頭から盗みます。
+     */
+    task* take(const size_t q) {
+        if (pending.load(std::memory_order_acquire) == 0) return nullptr;
+        {
+            std::lock_guard<std::mutex> lock(queues[q]->mutex);
+            auto& d = queues[q]->tasks;
+            if (!d.empty()) {
+                task* t = d.back();
+                d.pop_back();
+                pending.fetch_sub(1, std::memory_order_relaxed);
+                return t;
+            }
+        }
+        for (size_t i = 1; i <= queues.size(); i++) {
+            worker_queue& victim = *queues[(q + i) % queues.size()];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.tasks.empty()) {
+                task* t = victim.tasks.front();
+                victim.tasks.pop_front();
+                pending.fetch_sub(1, std::memory_order_relaxed);
+                return t;
+            }
+        }
+        return nullptr;
+    }
+
+    void worker_main(const size_t q) {
+        current() = worker_id{this, q};
+        while (!stopping.load(std::memory_order_acquire)) {
+            task* t = take(q);
+            if (t) {
+                t->run();
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(idle_mutex);
+            idle.wait_for(lock, std::chrono::milliseconds(1), [this] {
+                return stopping.load() || pending.load() > 0;
+            });
+        }
+    }
+
+    /*!
+     * タスクの完了を待つ間、他のタスクを実行します
+     */
+    void wait(const size_t q, task& t) {
+        while (!t.done.load(std::memory_order_acquire)) {
+            task* other = take(q);
+            if (other) other->run();
+            else std::this_thread::yield();
+        }
+    }
+
+public:
+
+    /*!
+     * @brief コンストラクタ
+     *
+     * @param n 呼び出し元のスレッドを含めたスレッドの数
+     */
+    explicit work_stealing_pool(const size_t n) : stopping(false), pending(0) {
+        const size_t workers = std::max<size_t>(n, 1) - 1;
+        for (size_t i = 0; i <= workers; i++) queues.emplace_back(new worker_queue());
+        for (size_t i = 1; i <= workers; i++) {
+            threads.emplace_back(&work_stealing_pool::worker_main, this, i);
+        }
+    }
+
+    ~work_stealing_pool() {
+        stopping.store(true, std::memory_order_release);
+        idle.notify_all();
+        for (auto& t : threads) t.join();
+    }
+
+    /*! @brief コピーは禁止されています */
+    work_stealing_pool(const work_stealing_pool&) = delete;
+    /*! @brief 代入は禁止されています */
+    work_stealing_pool& operator=(const work_stealing_pool&) = delete;
+
+    /*!
+     * @brief 呼び出し元のスレッドを含めたスレッドの数を返します
+     */
+    size_t size() const {return threads.size() + 1;}
+
+    /*!
+     * @brief f(0), ..., f(n - 1) を並列に実行し、全ての完了を待ちます
+     *
+     * f(0) は呼び出し元のスレッドで実行され、残りは他のスレッドに盗まれるまでキューに置かれます。
+     * いずれかが例外を送出した場合は、全ての完了を待ってから最初の例外を送出します。
+     */
+    template<class F>
+    void invoke(const size_t n, const F& f) {
+        if (n == 0) return;
+        const size_t q = own_queue();
+        std::vector<std::unique_ptr<task>> tasks;
+        for (size_t i = 1; i < n; i++) {
+            tasks.emplace_back(new task());
+            tasks.back()->fn = [&f, i] {f(i);};
+            tasks.back()->done.store(false, std::memory_order_relaxed);
+            push(q, tasks.back().get());
+        }
+
+        std::exception_ptr error;
+        try {
+            f(0);
+        }
+        catch (...) {
+            error = std::current_exception();
+        }
+
+        // 盗まれていないタスクは自分で実行する
+        for (size_t i = tasks.size(); i-- > 0;) {
+            task& t = *tasks[i];
+            if (pop_if(q, &t)) t.run();
+            else wait(q, t);
+        }
+        for (auto& t : tasks) {
+            if (!error && t->error) error = t->error;
+        }
+        if (error) std::rethrow_exception(error);
+    }
+};
+
+}
@@ -0,0 +1,7 @@
+#pragma once
+#include <cstdlib>
+#include <istream>
+#include <map>
+#include <queue>
+#include <boloq.h>
+#include <boloq/details/dimacs.h>
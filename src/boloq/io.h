@@ -1,19 +1,70 @@
 #pragma once
 #include <boloq/details/visitors/io.h>
+#include <boloq/details/export.h>
 
 namespace std {
 
-std::ostream& operator<<(std::ostream& os, const boloq::boolean_function& cmb) {
-    boloq::io_visitor<boloq::boolean_function> v(os);
+template<class T>
+std::ostream& operator<<(std::ostream& os, const boloq::basic_boolean_function<T>& cmb) {
+    boloq::io_visitor<boloq::basic_boolean_function<T>> v(os);
     cmb.accept(v);
     return os;
 }
 
-std::ostream& operator<<(std::ostream& os, const boloq::combination& cmb) {
-    boloq::io_visitor<boloq::combination> v(os);
+template<class T>
+std::ostream& operator<<(std::ostream& os, const boloq::basic_combination<T>& cmb) {
+    boloq::io_visitor<boloq::basic_combination<T>> v(os);
     cmb.accept(v);
     return os;
 }
 
+inline std::ostream& operator<<(std::ostream& os, const boloq::big_uint& n) {
+    return os << n.to_string();
 }
 
+}
+
+namespace boloq {
+
+/*!
+ * @brief 図を Graphviz の DOT 形式で書き出します
+ *
+ * 共有されたノードは一度だけ書き出します。
+ */
+template<class F>
+void write_dot(std::ostream& os, const std::vector<F>& fs) {
+    diagram_exporter<F>(fs).write_dot(os);
+}
+
+template<class F>
+void write_dot(std::ostream& os, const F& f) {
+    write_dot(os, std::vector<F>{f});
+}
+
+/*!
+ * @brief 図を JSON で書き出します
+ */
+template<class F>
+void write_json(std::ostream& os, const std::vector<F>& fs) {
+    diagram_exporter<F>(fs).write_json(os);
+}
+
+template<class F>
+void write_json(std::ostream& os, const F& f) {
+    write_json(os, std::vector<F>{f});
+}
+
+/*!
+ * @brief 図を辺の一覧で書き出します
+ */
+template<class F>
+void write_edge_list(std::ostream& os, const std::vector<F>& fs) {
+    diagram_exporter<F>(fs).write_edge_list(os);
+}
+
+template<class F>
+void write_edge_list(std::ostream& os, const F& f) {
+    write_edge_list(os, std::vector<F>{f});
+}
+
+}
@@ -0,0 +1,91 @@
+#pragma once
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <ostream>
+#include <system_error>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <boloq.h>
+#include <boloq/details/serialize.h>
+#include <boloq/details/mapped_diagram.h>
+
+namespace boloq {
+
+/*!
+ * @brief ファイルを読み取り専用で共有メモリに写像します
+ *
+ * 同じファイルを写像した複数のプロセスは、ページを共有します。
+ * POSIX の mmap を用います。
+ */
+class mapped_file {
+private:
+    void* _data;
+    size_t _size;
+
+    static void fail(const char* what) {
+        throw std::system_error(errno, std::generic_category(), std::string("boloq: ") + what);
+    }
+
+public:
+
+    /*!
+     * @brief ファイルを写像します
+     */
+    explicit mapped_file(const std::string& path) : _data(nullptr), _size(0) {
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) fail("failed to open mapped file");
+        struct stat st;
+        if (::fstat(fd, &st) != 0) {
+            const int e = errno;
+            ::close(fd);
+            errno = e;
+            fail("failed to stat mapped file");
+        }
+        _size = static_cast<size_t>(st.st_size);
+        if (_size > 0) {
+            _data = ::mmap(nullptr, _size, PROT_READ, MAP_SHARED, fd, 0);
+            if (_data == MAP_FAILED) {
+                const int e = errno;
+                ::close(fd);
+                errno = e;
+                _data = nullptr;
+                fail("failed to map file");
+            }
+        }
+        ::close(fd);
+    }
+
+    /*! @brief コピーは禁止されています */
+    mapped_file(const mapped_file&) = delete;
+    /*! @brief 代入は禁止されています */
+    mapped_file& operator=(const mapped_file&) = delete;
+
+    mapped_file(mapped_file&& o) : _data(o._data), _size(o._size) {
+        o._data = nullptr;
+        o._size = 0;
+    }
+
+    ~mapped_file() {
+        if (_data) ::munmap(_data, _size);
+    }
+
+    /*! @brief 写像した領域の先頭を返します */
+    const void* data() const {return _data;}
+    /*! @brief 写像した領域のバイト数を返します */
+    size_t size() const {return _size;}
+};
+
+/*!
+ * @brief 図を mmap で参照できる配置形式で書き出します
+ *
+ * mapped_file で写像し、mapped_boolean_function や mapped_combination で参照します。
+ */
+template<class F>
+void save_mapped(std::ostream& os, const F& f) {
+    mapped_writer<F>(os).write(f);
+}
+
+}
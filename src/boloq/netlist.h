@@ -0,0 +1,8 @@
+#pragma once
+#include <array>
+#include <cctype>
+#include <istream>
+#include <sstream>
+#include <boloq.h>
+#include <boloq/ordering.h>
+#include <boloq/details/netlist.h>
@@ -0,0 +1,5 @@
+#pragma once
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
+#include <boloq/details/ordering.h>
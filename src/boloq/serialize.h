@@ -0,0 +1,62 @@
+#pragma once
+#include <istream>
+#include <ostream>
+#include <boloq.h>
+#include <boloq/details/serialize.h>
+
+namespace boloq {
+
+/*!
+ * @brief 同じテーブルに属する図をまとめて二進形式で書き出します
+ *
+ * 図どうしが共有するノードは一度だけ書き出します。
+ * 形式は diagram_writer を参照してください。
+ */
+template<class F>
+void save_diagrams(std::ostream& os, const std::vector<F>& fs) {
+    diagram_writer<F>(os).write(fs);
+}
+
+/*!
+ * @brief 図を二進形式で書き出します
+ */
+template<class F>
+void save_diagram(std::ostream& os, const F& f) {
+    save_diagrams(os, std::vector<F>{f});
+}
+
+/*!
+ * @brief save_diagrams で書き出した図を指定したテーブルに読み込みます
+ */
+template<class F>
+std::vector<F> load_diagrams(std::istream& is, typename F::table_type& t) {
+    return diagram_reader<F>(is).read(t);
+}
+
+/*!
+ * @brief save_diagrams で書き出した図を既定のテーブルに読み込みます
+ */
+template<class F>
+std::vector<F> load_diagrams(std::istream& is) {
+    return load_diagrams<F>(is, F::table());
+}
+
+/*!
+ * @brief save_diagram で書き出した図を指定したテーブルに読み込みます
+ */
+template<class F>
+F load_diagram(std::istream& is, typename F::table_type& t) {
+    std::vector<F> fs = load_diagrams<F>(is, t);
+    if (fs.size() != 1) throw std::runtime_error("boloq: expected a single diagram");
+    return fs[0];
+}
+
+/*!
+ * @brief save_diagram で書き出した図を既定のテーブルに読み込みます
+ */
+template<class F>
+F load_diagram(std::istream& is) {
+    return load_diagram<F>(is, F::table());
+}
+
+}
@@ -2,11 +2,20 @@
 #define BOOST_TEST_MAIN
 #include <boloq.h>
 #include <boloq/io.h>
+#include <boloq/ordering.h>
+#include <boloq/serialize.h>
+#include <boloq/mapped.h>
+#include <boloq/dimacs.h>
+#include <boloq/netlist.h>
 
 #include <boost/test/unit_test.hpp>
 #include <array>
+#include <set>
+#include <fstream>
+#include <sstream>
 #include <unordered_set>
 #include <iostream>
+#include <thread>
 
 using namespace std;
 using namespace boloq;
@@ -87,6 +96,345 @@ BOOST_AUTO_TEST_CASE(test_hash_test) {
     BOOST_REQUIRE_EQUAL(fn_set.size(), 4);
 }
 
+BOOST_AUTO_TEST_CASE(test_many_nodes) {
+    // unique table の拡張をまたいでもノードが共有されることを確認する
+    boolean_function f = boolean_function::zero(), g = boolean_function::zero();
+    for (size_t i = 0; i < 64; i++) f ^= boolean_function(i);
+    for (size_t i = 64; i-- > 0;) g ^= boolean_function(i);
+    BOOST_REQUIRE(f == g);
+    BOOST_REQUIRE(f.is_exclusive_disjunction());
+}
+
+BOOST_AUTO_TEST_CASE(test_sparse_labels) {
+    // ラベルの値に比例する領域を確保しない
+    const size_t big = size_t(1) << 40;
+    boolean_function a(big), b(3);
+    const auto f = a & b;
+    BOOST_REQUIRE(f.is_conjunction());
+    auto assigns = assign_generator({{big, 3}});
+    for (auto& assign : assigns) {
+        BOOST_REQUIRE_EQUAL(f.execute(assign), assign[big] && assign[3]);
+    }
+
+    arena_boolean_function_manager m;
+    const uint32_t top = std::numeric_limits<uint32_t>::max() - 1;
+    const auto g = m.var(top) ^ m.var(7);
+    BOOST_REQUIRE(g.is_exclusive_disjunction());
+    BOOST_REQUIRE_LT(m.table().level(7), m.table().level(top));
+}
+
+BOOST_AUTO_TEST_CASE(test_bounded_cache) {
+    auto& table = arena_boolean_function::table();
+    table.set_cache_size(4);
+    table.set_cache_auto_resize(0);
+
+    // キャッシュが小さくても結果は正しい
+    vector<arena_boolean_function> xs;
+    for (size_t i = 0; i < 8; i++) xs.emplace_back(i);
+    auto f = arena_boolean_function::zero();
+    for (size_t i = 0; i < 8; i += 2) f |= xs[i] & xs[i + 1];
+    auto g = arena_boolean_function::zero();
+    for (size_t i = 8; i > 0; i -= 2) g = (xs[i - 1] & xs[i - 2]) | g;
+    BOOST_REQUIRE(f == g);
+
+    // 演算ごとに 16 エントリのキャッシュを持つ
+    const auto stats = table.cache_statistics();
+    BOOST_REQUIRE_EQUAL(stats.capacity % 16, 0);
+    BOOST_REQUIRE(stats.capacity < 16 * 16);
+    BOOST_REQUIRE(stats.evictions > 0);
+
+    table.set_cache_size(12);
+    table.set_cache_auto_resize(18);
+}
+
+BOOST_AUTO_TEST_CASE(test_shared_polarity_size) {
+    // y は正負両方の枝から参照されるが、1 つのノードとして数える
+    complement_boolean_function x(1), y(2);
+    BOOST_REQUIRE_EQUAL((x ^ y).size(), 2u);
+    BOOST_REQUIRE_EQUAL((~(x ^ y)).size(), 2u);
+
+    auto f = complement_boolean_function::zero();
+    for (size_t i = 300; i < 316; i++) f ^= complement_boolean_function(i);
+    BOOST_REQUIRE_EQUAL(f.size(), 16u);
+}
+
+BOOST_AUTO_TEST_CASE(test_ite_normalization) {
+    auto& table = boolean_function::table();
+    const auto x = table.new_var(200), y = table.new_var(201), z = table.new_var(202);
+    const auto xy = table.ite(x, y, table.zero());
+    const auto f = table.ite(xy, table.one(), z);
+
+    // 可換な演算は同じ計算結果を再利用する
+    const auto before = table.normalization_statistics();
+    const auto g = table.ite(z, table.one(), table.ite(y, x, table.zero()));
+    const auto after = table.normalization_statistics();
+    BOOST_REQUIRE(f == g);
+    BOOST_REQUIRE_EQUAL(after.normalized_hits - before.normalized_hits, 2);
+
+    // 終端の規則
+    BOOST_REQUIRE(table.ite(f, table.one(), table.zero()) == f);
+    BOOST_REQUIRE(table.ite(x, f, f) == f);
+    BOOST_REQUIRE(table.ite(f, f, table.zero()) == f);
+    BOOST_REQUIRE(table.normalization_statistics().terminal_cases > after.terminal_cases);
+}
+
+template<class F>
+void check_binary_operators() {
+    F x(210), y(211), z(212);
+    auto p = x & ~z, q = y | z;
+    auto assigns = assign_generator({{210, 211, 212}});
+    for (auto& assign : assigns) {
+        const bool a = assign[210] && !assign[212], b = assign[211] || assign[212];
+        BOOST_REQUIRE_EQUAL((p & q).execute(assign), a && b);
+        BOOST_REQUIRE_EQUAL((p | q).execute(assign), a || b);
+        BOOST_REQUIRE_EQUAL((p ^ q).execute(assign), a != b);
+        BOOST_REQUIRE_EQUAL(p.nand(q).execute(assign), !(a && b));
+        BOOST_REQUIRE_EQUAL(p.xnor(q).execute(assign), a == b);
+        BOOST_REQUIRE_EQUAL(p.implies(q).execute(assign), !a || b);
+    }
+    BOOST_REQUIRE(p.nand(q) == ~(q & p));
+    BOOST_REQUIRE(p.xnor(q) == ~(q ^ p));
+    BOOST_REQUIRE(p.implies(q) == (~p | q));
+    BOOST_REQUIRE(p.implies(p) == F::one());
+    BOOST_REQUIRE(F::zero().implies(p) == F::one());
+}
+
+BOOST_AUTO_TEST_CASE(test_binary_operators) {
+    check_binary_operators<boolean_function>();
+    check_binary_operators<arena_boolean_function>();
+    check_binary_operators<complement_boolean_function>();
+}
+
+template<class F>
+void check_quantification() {
+    F x(220), y(221), z(222), w(223);
+    auto f = (x & y) | (~x & z & w);
+    auto g = (y ^ z) | w;
+    auto assigns = assign_generator({{220, 221, 222, 223}});
+    for (auto& assign : assigns) {
+        auto a0 = assign, a1 = assign;
+        a0[220] = false;
+        a1[220] = true;
+        const bool e = f.execute(a0) || f.execute(a1);
+        const bool u = f.execute(a0) && f.execute(a1);
+        const bool r = (f.execute(a0) && g.execute(a0)) || (f.execute(a1) && g.execute(a1));
+        BOOST_REQUIRE_EQUAL(f.exists({220}).execute(assign), e);
+        BOOST_REQUIRE_EQUAL(f.forall({220}).execute(assign), u);
+        BOOST_REQUIRE_EQUAL(f.and_exists(g, {220}).execute(assign), r);
+    }
+    BOOST_REQUIRE(f.exists({220, 222}) == (y | w));
+    BOOST_REQUIRE(f.forall({220}) == (y & z & w));
+    BOOST_REQUIRE(f.exists({}) == f);
+    BOOST_REQUIRE(f.and_exists(g, {221, 223}) == (f & g).exists({221, 223}));
+    BOOST_REQUIRE(f.and_exists(g, {220, 221, 222, 223}) == F::one());
+    BOOST_REQUIRE(f.and_exists(~f, {220}) == F::zero());
+}
+
+BOOST_AUTO_TEST_CASE(test_quantification) {
+    check_quantification<boolean_function>();
+    check_quantification<arena_boolean_function>();
+    check_quantification<complement_boolean_function>();
+}
+
+template<class F>
+void check_substitution() {
+    F x(230), y(231), z(232), w(233);
+    auto f = (x & y) | (~x & z) | (y & w);
+    auto assigns = assign_generator({{230, 231, 232, 233}});
+    auto g = y ^ w, h = x & z;
+    for (auto& assign : assigns) {
+        auto a0 = assign, a1 = assign, ag = assign, av = assign;
+        a0[230] = false;
+        a1[230] = true;
+        ag[230] = g.execute(assign);
+        av[230] = g.execute(assign);
+        av[232] = h.execute(assign);
+        BOOST_REQUIRE_EQUAL(f.cofactor(230, false).execute(assign), f.execute(a0));
+        BOOST_REQUIRE_EQUAL(f.cofactor(230, true).execute(assign), f.execute(a1));
+        BOOST_REQUIRE_EQUAL(f.compose(230, g).execute(assign), f.execute(ag));
+        BOOST_REQUIRE_EQUAL(f.vector_compose({{230, g}, {232, h}}).execute(assign), f.execute(av));
+    }
+    BOOST_REQUIRE(f.cofactor(231, true).cofactor(230, true) == F::one());
+    BOOST_REQUIRE(f.compose(230, x) == f);
+    BOOST_REQUIRE(f.vector_compose({{230, g}}) == f.compose(230, g));
+    // 同時に置き換えるため、x と y を入れ替えられる
+    BOOST_REQUIRE((x & ~y).vector_compose({{230, y}, {231, x}}) == (y & ~x));
+    // 置き換えの表はラベルの値に比例しない
+    const auto big = std::numeric_limits<typename F::label_type>::max() - 1;
+    BOOST_REQUIRE((F(big) & y).vector_compose({{big, ~y}}) == F::zero());
+
+    // care が 1 の割り当てでは一致し、ノードは増えない
+    auto care = x | z;
+    auto r = f.restrict(care);
+    for (auto& assign : assigns) {
+        if (care.execute(assign)) BOOST_REQUIRE_EQUAL(r.execute(assign), f.execute(assign));
+    }
+    BOOST_REQUIRE(f.restrict(F::one()) == f);
+    BOOST_REQUIRE(f.restrict(f) == F::one());
+    BOOST_REQUIRE(f.restrict(x) == f.cofactor(230, true));
+}
+
+BOOST_AUTO_TEST_CASE(test_substitution) {
+    check_substitution<boolean_function>();
+    check_substitution<arena_boolean_function>();
+    check_substitution<complement_boolean_function>();
+}
+
+template<class M>
+void check_satcount() {
+    M m;
+    auto x = m.var(0), y = m.var(1), z = m.var(3);
+    BOOST_REQUIRE_EQUAL((x & y).satcount(4), 4u);
+    BOOST_REQUIRE_EQUAL((x | z).satcount(4), 12u);
+    BOOST_REQUIRE_EQUAL((x ^ y ^ z).satcount(4), 8u);
+    BOOST_REQUIRE_EQUAL(m.one().satcount(4), 16u);
+    BOOST_REQUIRE_EQUAL(m.zero().satcount(4), 0u);
+    BOOST_REQUIRE_EQUAL((~x & z).template satcount<double>(4), 4.0);
+    BOOST_REQUIRE_CLOSE((x | z).template satcount<log2_count>(4).count(), 12.0, 1e-9);
+    BOOST_CHECK_THROW(z.satcount(3), std::invalid_argument);
+
+    // 64bit に収まらない数
+    auto w = m.var(99);
+    BOOST_REQUIRE_EQUAL(m.one().template satcount<big_uint>(100).to_string(), "1267650600228229401496703205376");
+    BOOST_REQUIRE_EQUAL((x & ~w).template satcount<big_uint>(100).to_string(), "316912650057057350374175801344");
+#ifdef __SIZEOF_INT128__
+    BOOST_REQUIRE((x | w).template satcount<unsigned __int128>(100) ==
+                  (static_cast<unsigned __int128>(3) << 98));
+#endif
+    BOOST_REQUIRE_CLOSE((x | w).template satcount<log2_count>(100).value, 98 + std::log2(3.0), 1e-9);
+}
+
+BOOST_AUTO_TEST_CASE(test_satcount) {
+    check_satcount<boolean_function_manager>();
+    check_satcount<complement_boolean_function_manager>();
+
+    // 順序を変更しても数は変わらない
+    arena_boolean_function_manager m;
+    auto f = m.zero();
+    for (size_t i = 0; i < 4; i++) f |= m.var(i) & m.var(4 + i);
+    const auto before = f.satcount(8);
+    m.table().reorder();
+    BOOST_REQUIRE_EQUAL(f.satcount(8), before);
+    BOOST_REQUIRE_EQUAL(before, 256u - 81u);
+}
+
+template<class F>
+void check_cubes() {
+    F x(240), y(241), z(242);
+    auto f = (x & y) | (~x & z);
+    // 各割り当てはちょうど f の値の数のキューブに含まれる
+    auto assigns = assign_generator({{240, 241, 242}});
+    for (auto& assign : assigns) {
+        size_t matches = 0;
+        for (const auto& cube : f) {
+            bool match = true;
+            for (const auto& literal : cube) match = match && (assign[literal.first] == literal.second);
+            matches += match;
+        }
+        BOOST_REQUIRE_EQUAL(matches, f.execute(assign) ? 1u : 0u);
+    }
+    BOOST_REQUIRE_EQUAL(distance(f.begin(), f.end()), 2);
+    BOOST_REQUIRE(F::zero().begin() == F::zero().end());
+    BOOST_REQUIRE_EQUAL(distance(F::one().begin(), F::one().end()), 1);
+    BOOST_REQUIRE(F::one().begin()->empty());
+}
+
+BOOST_AUTO_TEST_CASE(test_cube_iterator) {
+    check_cubes<boolean_function>();
+    check_cubes<arena_boolean_function>();
+    check_cubes<complement_boolean_function>();
+}
+
+template<class F, class W>
+void check_batch() {
+    F a(0), b(1), c(2), d(3), e(4);
+    auto f = (a & ~b) ^ (c | (d & e));
+    // 5 変数の 32 通りの割り当てを繰り返して 300 個並べる
+    const size_t n = 300, words = (n + 63) / 64;
+    vector<vector<uint64_t>> columns(5, vector<uint64_t>(words, 0));
+    for (size_t i = 0; i < n; i++) {
+        for (size_t l = 0; l < 5; l++) {
+            if ((i % 32) & (1u << l)) columns[l][i / 64] |= uint64_t(1) << (i % 64);
+        }
+    }
+    const auto result = f.template execute_batch<W>(columns);
+    BOOST_REQUIRE_EQUAL(result.size(), words);
+    for (size_t i = 0; i < n; i++) {
+        unordered_map<size_t, bool> assign;
+        for (size_t l = 0; l < 5; l++) assign[l] = (i % 32) & (1u << l);
+        BOOST_REQUIRE_EQUAL(bool((result[i / 64] >> (i % 64)) & 1), f.execute(assign));
+    }
+    BOOST_REQUIRE_EQUAL(F::one().template execute_batch<W>(columns)[0], ~uint64_t(0));
+    BOOST_REQUIRE_EQUAL(F::zero().template execute_batch<W>(columns)[0], 0u);
+}
+
+BOOST_AUTO_TEST_CASE(test_execute_batch) {
+    check_batch<boolean_function, uint64_t>();
+    check_batch<arena_boolean_function, bit_lanes256>();
+    check_batch<complement_boolean_function, bit_lanes512>();
+    BOOST_REQUIRE_THROW((boolean_function(3) & boolean_function(5)).execute_batch(vector<vector<uint64_t>>(1)),
+                        invalid_argument);
+
+    // 列は現れた変数だけをラベルの順に詰める
+    const size_t big = size_t(1) << 40;
+    batch_evaluator<boolean_function> e(boolean_function(big) & ~boolean_function(7));
+    BOOST_REQUIRE_EQUAL(e.input_count(), 2u);
+    BOOST_REQUIRE(e.labels() == vector<size_t>({7, big}));
+    const uint64_t inputs[2] = {0xc, 0xa};
+    BOOST_REQUIRE_EQUAL(e.evaluate(inputs), ~uint64_t(0xc) & 0xa);
+}
+
+template<class F>
+void check_compile() {
+    F a(0), b(1), c(2), d(3);
+    const auto compiled = ((a & ~b) | (c ^ d)).compile();
+    {
+        // 元の論理関数が破棄されても評価できる
+        auto f = (a & ~b) | (c ^ d);
+        BOOST_REQUIRE_EQUAL(compiled.input_count(), 4u);
+        for (size_t i = 0; i < 16; i++) {
+            bool inputs[4];
+            unordered_map<size_t, bool> assign;
+            for (size_t l = 0; l < 4; l++) assign[l] = inputs[l] = (i >> l) & 1;
+            BOOST_REQUIRE_EQUAL(compiled.evaluate(inputs), f.execute(assign));
+            BOOST_REQUIRE_EQUAL(compiled.evaluate(bitset<4>(i)), f.execute(assign));
+        }
+    }
+    BOOST_REQUIRE(F::one().compile().evaluate(static_cast<const bool*>(nullptr)));
+    BOOST_REQUIRE(!F::zero().compile().evaluate(static_cast<const bool*>(nullptr)));
+    BOOST_REQUIRE_THROW(compiled.evaluate(bitset<2>()), invalid_argument);
+
+    // 入力は現れた変数だけをラベルの順に詰める
+    const auto big = std::numeric_limits<typename F::label_type>::max() - 1;
+    const auto sparse = (F(big) & ~c).compile();
+    BOOST_REQUIRE_EQUAL(sparse.input_count(), 2u);
+    BOOST_REQUIRE(sparse.labels() == vector<typename F::label_type>({2, big}));
+    BOOST_REQUIRE(sparse.evaluate(bitset<2>(2)));
+    BOOST_REQUIRE(!sparse.evaluate(bitset<2>(3)));
+}
+
+BOOST_AUTO_TEST_CASE(test_compile) {
+    check_compile<boolean_function>();
+    check_compile<arena_boolean_function>();
+    check_compile<complement_boolean_function>();
+}
+
+BOOST_AUTO_TEST_CASE(test_gc) {
+    boolean_function x(100), y(101);
+    auto f = x & ~y;
+    {
+        auto g = boolean_function::zero();
+        for (size_t i = 102; i < 110; i++) g ^= boolean_function(i) & x;
+    }
+    const auto s = boolean_function::table().gc();
+    BOOST_REQUIRE(s.nodes > 0);
+    BOOST_REQUIRE_EQUAL(s.indices, s.nodes);
+    BOOST_REQUIRE_EQUAL(boolean_function::table().gc().nodes, 0);
+
+    // 回収後も生存している関数は正しく扱える
+    BOOST_REQUIRE(f == ~(~x | y));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 BOOST_AUTO_TEST_SUITE(boloq_combination_test)
@@ -123,6 +471,17 @@ BOOST_AUTO_TEST_CASE(test_change) {
     for (auto& a : assigns) BOOST_REQUIRE_EQUAL(f.contain(a), a['x']);
 }
 
+BOOST_AUTO_TEST_CASE(test_contain_unmentioned) {
+    combination x('x'), y('y');
+    // 割り当てに現れないアイテムは、先にあっても後にあっても含まれない
+    const auto f = x + y;
+    BOOST_REQUIRE(f.contain(unordered_map<size_t, bool>{{'y', true}}));
+    BOOST_REQUIRE(!(x * y).contain(unordered_map<size_t, bool>{{'y', true}}));
+    const auto g = x * y + x;
+    BOOST_REQUIRE(g.contain(unordered_map<size_t, bool>{{'x', true}}));
+    BOOST_REQUIRE(!(x * y).contain(unordered_map<size_t, bool>{{'x', true}}));
+}
+
 BOOST_AUTO_TEST_CASE(test_union) {
     combination x('x'), y('y');
     auto f = x + y + x.changed('y');
@@ -161,6 +520,120 @@ BOOST_AUTO_TEST_CASE(test_meet) {
     BOOST_REQUIRE_EQUAL(f.meet(y * z), y + z);
 }
 
+BOOST_AUTO_TEST_CASE(test_subtract) {
+    combination x('x'), y('y'), z('z');
+    auto f = x * y + y + z + combination::one();
+    BOOST_REQUIRE_EQUAL(f - y, x * y + z + combination::one());
+    BOOST_REQUIRE_EQUAL(f - (x * y + combination::one()), y + z);
+    BOOST_REQUIRE_EQUAL(f - x, f);
+    BOOST_REQUIRE_EQUAL(f - f, combination::zero());
+    auto g = f;
+    g -= z;
+    BOOST_REQUIRE_EQUAL(g + z, f);
+}
+
+BOOST_AUTO_TEST_CASE(test_divide) {
+    combination a('a'), b('b'), c('c'), d('d'), e('e');
+    auto f = a * b * c + a * b * d + c * e;
+    BOOST_REQUIRE_EQUAL(f / (a * b), c + d);
+    BOOST_REQUIRE_EQUAL(f % (a * b), c * e);
+    BOOST_REQUIRE_EQUAL(f / c, a * b + e);
+    BOOST_REQUIRE_EQUAL(f / (c + d), a * b);
+    BOOST_REQUIRE_EQUAL(f % (c + d), c * e);
+    BOOST_REQUIRE_EQUAL(f / combination::one(), f);
+    BOOST_REQUIRE_EQUAL(f / f, combination::one());
+    BOOST_REQUIRE_EQUAL(f / (a * e), combination::zero());
+    for (const auto& g : {a, c, a * b, c + d, c + e, a + e}) {
+        BOOST_REQUIRE_EQUAL((f / g) * g + f % g, f);
+    }
+    auto h = f;
+    h /= c;
+    h %= e;
+    BOOST_REQUIRE_EQUAL(h, a * b);
+    BOOST_REQUIRE_THROW(f / combination::zero(), invalid_argument);
+}
+
+/*!
+ * 5 アイテムの集合をビットで、その族を 32bit の語で表して組み合わせ集合を作ります
+ */
+template<class F>
+F make_family(const uint32_t family) {
+    auto f = F::zero();
+    for (uint32_t s = 0; s < 32; s++) {
+        if (!((family >> s) & 1)) continue;
+        auto m = F::one();
+        for (size_t i = 0; i < 5; i++) {
+            if ((s >> i) & 1) m.change(i);
+        }
+        f += m;
+    }
+    return f;
+}
+
+template<class F>
+uint32_t family_of(const F& f) {
+    uint32_t family = 0;
+    for (uint32_t s = 0; s < 32; s++) {
+        unordered_map<size_t, bool> assign;
+        for (size_t i = 0; i < 5; i++) assign[i] = (s >> i) & 1;
+        if (f.contain(assign)) family |= uint32_t(1) << s;
+    }
+    return family;
+}
+
+template<class F>
+void check_set_algebra() {
+    const auto members = [](const uint32_t family) {
+        vector<uint32_t> r;
+        for (uint32_t s = 0; s < 32; s++) {
+            if ((family >> s) & 1) r.push_back(s);
+        }
+        return r;
+    };
+    uint64_t seed = 12345;
+    const auto next = [&seed]() {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        // 共通のアイテムが多くなるように、疎な族と密な族を混ぜる
+        const uint32_t r = static_cast<uint32_t>(seed >> 32);
+        return (seed & 1) ? r : r & static_cast<uint32_t>(seed >> 7);
+    };
+    for (size_t round = 0; round < 300; round++) {
+        const uint32_t a = next(), b = next();
+        uint32_t join = 0, meet = 0;
+        for (const uint32_t p : members(a)) {
+            for (const uint32_t q : members(b)) {
+                join |= uint32_t(1) << (p | q);
+                meet |= uint32_t(1) << (p & q);
+            }
+        }
+        const F fa = make_family<F>(a), fb = make_family<F>(b);
+        BOOST_REQUIRE_EQUAL(family_of(fa * fb), join);
+        BOOST_REQUIRE_EQUAL(family_of(fa.meet(fb)), meet);
+        if (b == 0) {
+            BOOST_REQUIRE_THROW(fa / fb, invalid_argument);
+            continue;
+        }
+        // 商は全ての q について p | q が a に含まれる、q と交わらない p の族
+        uint32_t quotient = 0;
+        for (uint32_t p = 0; p < 32; p++) {
+            bool all = true;
+            for (const uint32_t q : members(b)) all = all && !(p & q) && ((a >> (p | q)) & 1);
+            if (all) quotient |= uint32_t(1) << p;
+        }
+        uint32_t product = 0;
+        for (const uint32_t p : members(quotient)) {
+            for (const uint32_t q : members(b)) product |= uint32_t(1) << (p | q);
+        }
+        BOOST_REQUIRE_EQUAL(family_of(fa / fb), quotient);
+        BOOST_REQUIRE_EQUAL(family_of(fa % fb), a & ~product);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_set_algebra) {
+    check_set_algebra<combination>();
+    check_set_algebra<arena_combination>();
+}
+
 BOOST_AUTO_TEST_CASE(test_construction) {
     combination _0001('d');
     combination _000x = _0001 + combination::one();
@@ -268,3 +741,830 @@ BOOST_AUTO_TEST_CASE(test_is_exclusive_disjunction) {
 }
 
 BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(boloq_arena_test)
+
+BOOST_AUTO_TEST_CASE(test_node_size) {
+    BOOST_REQUIRE_EQUAL(sizeof(arena_node), 16);
+}
+
+BOOST_AUTO_TEST_CASE(test_boolean_function) {
+    arena_boolean_function x('x'), y('y'), z('z');
+
+    BOOST_REQUIRE((~x | ~y) == ~(x & y));
+    BOOST_REQUIRE((~x & ~y) == ~(x | y));
+    BOOST_REQUIRE((x ^ y ^ z).is_exclusive_disjunction());
+    BOOST_REQUIRE(!(x & y).is_exclusive_disjunction());
+
+    auto f = (x & y) | (~x & z);
+    auto assigns = assign_generator({{'x', 'y', 'z'}});
+    for (auto& assign : assigns) {
+        BOOST_REQUIRE_EQUAL(f.execute(assign), assign['x'] ? assign['y'] : assign['z']);
+    }
+
+    unordered_set<arena_boolean_function> fn_set = {{~x | ~y, ~(x & y), x ^ y}};
+    BOOST_REQUIRE_EQUAL(fn_set.size(), 2);
+}
+
+BOOST_AUTO_TEST_CASE(test_gc) {
+    auto& table = arena_boolean_function::table();
+    arena_boolean_function x(200), y(201);
+    auto f = x | y;
+    table.gc();
+
+    for (int round = 0; round < 2; round++) {
+        {
+            auto g = arena_boolean_function::zero();
+            for (size_t i = 202; i < 220; i++) g ^= arena_boolean_function(i) & f;
+            BOOST_REQUIRE(g.is_exclusive_disjunction() == false);
+        }
+        const auto s = table.gc();
+        BOOST_REQUIRE(s.nodes > 0);
+        BOOST_REQUIRE_EQUAL(table.gc().nodes, 0);
+    }
+
+    auto assigns = assign_generator({{200, 201}});
+    for (auto& assign : assigns) {
+        BOOST_REQUIRE_EQUAL(f.execute(assign), assign[200] || assign[201]);
+    }
+    BOOST_REQUIRE(f == ~(~x & ~y));
+}
+
+BOOST_AUTO_TEST_CASE(test_auto_gc) {
+    // 全ての演算の後に回収が行われても結果は変わらない
+    auto& table = arena_combination::table();
+    table.set_gc_threshold(0.0, 0);
+    arena_combination x('x'), y('y'), z('z');
+    auto f = (x + y) * (y + z);
+    BOOST_REQUIRE_EQUAL(f, x * y + x * z + y + y * z);
+    BOOST_REQUIRE_EQUAL(f.meet(x * z), x + z + x * z + arena_combination::one());
+    table.set_gc_threshold(0.5);
+}
+
+BOOST_AUTO_TEST_CASE(test_deep_diagram) {
+    // 変数の数だけ深い演算でも C++ のスタックは溢れない
+    const uint32_t n = 100000;
+    auto f = arena_boolean_function(n - 1);
+    auto g = ~arena_boolean_function(n - 1);
+    for (uint32_t i = n - 1; i-- > 0;) {
+        f = arena_boolean_function(i) & f;
+        g = arena_boolean_function(i) & g;
+    }
+    BOOST_REQUIRE((f & g) == arena_boolean_function::zero());
+    BOOST_REQUIRE((f ^ g) == (f | g));
+    BOOST_REQUIRE(f.is_conjunction());
+    vector<bool> assign(n, true);
+    BOOST_REQUIRE(f.execute(assign));
+    BOOST_REQUIRE(!g.execute(assign));
+
+    auto p = arena_combination::one(), q = arena_combination::one();
+    for (uint32_t i = n; i-- > 0;) {
+        p.change(i);
+        if (i != n / 2) q.change(i);
+    }
+    count_visitor<arena_combination, size_t> cv;
+    BOOST_REQUIRE_EQUAL((p + q).accept(cv), 2);
+    BOOST_REQUIRE((p & q) == arena_combination::zero());
+    BOOST_REQUIRE(((p + q) & p) == p);
+}
+
+BOOST_AUTO_TEST_CASE(test_combination) {
+    arena_combination x('x'), y('y'), z('z'), w('w');
+    BOOST_REQUIRE_EQUAL(x * y, x.changed('y'));
+    BOOST_REQUIRE_EQUAL((x * y + x * z).meet(y * z), y + z);
+
+    count_visitor<arena_combination, size_t> cv;
+    BOOST_REQUIRE_EQUAL(((x + y) * (z + w)).accept(cv), 4);
+}
+
+BOOST_AUTO_TEST_CASE(test_set_iterator) {
+    arena_combination_manager m;
+    auto s = m.zero();
+    for (size_t i = 0; i < 8; i++) s += m.var(i);
+    auto p = s * s;
+    set<vector<uint32_t>> seen;
+    for (const auto& items : p) {
+        BOOST_REQUIRE(items.size() == 1 || items.size() == 2);
+        unordered_map<size_t, bool> assign;
+        for (size_t i = 0; i < 8; i++) assign[i] = false;
+        for (const auto l : items) assign[l] = true;
+        BOOST_REQUIRE(p.contain(assign));
+        seen.insert(items);
+    }
+    BOOST_REQUIRE_EQUAL(seen.size(), p.count());
+
+    // 途中で止められる
+    auto all = m.one();
+    for (size_t i = 0; i < 60; i++) all = all * (m.one() + m.var(i));
+    size_t n = 0;
+    for (auto it = all.begin(); it != all.end() && n < 1000; ++it) n++;
+    BOOST_REQUIRE_EQUAL(n, 1000u);
+    BOOST_REQUIRE(m.zero().begin() == m.zero().end());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(boloq_complement_test)
+
+BOOST_AUTO_TEST_CASE(test_negation) {
+    complement_boolean_function x('x'), y('y'), z('z');
+    auto f = (x & y) | z;
+
+    // 否定はノードを生成しない
+    const size_t n = complement_boolean_function::table().size();
+    auto g = ~f;
+    BOOST_REQUIRE_EQUAL(complement_boolean_function::table().size(), n);
+    BOOST_REQUIRE(g != f);
+    BOOST_REQUIRE(~g == f);
+    BOOST_REQUIRE(g == ((~x | ~y) & ~z));
+
+    BOOST_REQUIRE(~complement_boolean_function::one() == complement_boolean_function::zero());
+    BOOST_REQUIRE((~x).is_negation());
+    BOOST_REQUIRE(x.is_wire());
+
+    auto assigns = assign_generator({{'x', 'y', 'z'}});
+    for (auto& assign : assigns) {
+        BOOST_REQUIRE_EQUAL(g.execute(assign), !((assign['x'] && assign['y']) || assign['z']));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_parity) {
+    // 否定枝を用いると n 変数のパリティ関数は n ノードで表される
+    auto& table = complement_boolean_function::table();
+    table.gc();
+    const size_t n = table.size();
+    auto f = complement_boolean_function::zero();
+    for (size_t i = 300; i < 316; i++) f ^= complement_boolean_function(i);
+    table.gc();
+    BOOST_REQUIRE_EQUAL(table.size() - n, 16);
+    BOOST_REQUIRE(f.is_exclusive_disjunction());
+
+    auto assigns = assign_generator({{300, 301, 302, 315}});
+    for (auto& assign : assigns) {
+        for (size_t i = 303; i < 315; i++) assign[i] = false;
+        BOOST_REQUIRE_EQUAL(f.execute(assign),
+                assign[300] ^ assign[301] ^ assign[302] ^ assign[315]);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_ite_normalization) {
+    auto& table = complement_boolean_function::table();
+    const auto x = table.new_var(400), y = table.new_var(401);
+    const auto one = table.one(), zero = table.zero();
+
+    // ite(~x, 1, y) と ite(y, 1, ~x) と ite(~y, ~x, 1) は同じ標準形 ite(x, y, 1) になる
+    const auto n = table.apply_not(x);
+    const auto p = table.ite(n, one, y);
+    const auto before = table.normalization_statistics();
+    BOOST_REQUIRE(table.ite(y, one, n) == p);
+    BOOST_REQUIRE(table.ite(table.apply_not(y), n, one) == p);
+    BOOST_REQUIRE_EQUAL(table.normalization_statistics().normalized_hits - before.normalized_hits, 2);
+    BOOST_REQUIRE(table.ite(x, zero, one) == n);
+
+    complement_boolean_function a(400), b(401);
+    BOOST_REQUIRE(a.implies(b) == ~(a & ~b));
+    auto assigns = assign_generator({{400, 401}});
+    for (auto& assign : assigns) {
+        BOOST_REQUIRE_EQUAL(a.implies(b).execute(assign), !assign[400] || assign[401]);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_gc) {
+    complement_boolean_function x('x'), y('y');
+    auto f = ~(x ^ y);
+    complement_boolean_function::table().gc();
+    BOOST_REQUIRE(f == ((x & y) | (~x & ~y)));
+    BOOST_REQUIRE_EQUAL(f.execute(assign_generator({{'x', 'y'}})[0]), true);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(boloq_parallel_test)
+
+BOOST_AUTO_TEST_CASE(test_boolean_function) {
+    auto& table = parallel_boolean_function::table();
+    table.set_threads(4);
+    BOOST_REQUIRE_EQUAL(table.threads(), 4);
+
+    vector<parallel_boolean_function> xs;
+    for (size_t i = 0; i < 12; i++) xs.emplace_back(i);
+    auto parity = parallel_boolean_function::zero();
+    auto majority = parallel_boolean_function::zero();
+    for (size_t i = 0; i < 12; i++) parity ^= xs[i];
+    for (size_t i = 0; i < 12; i += 3) {
+        majority |= (xs[i] & xs[i + 1]) | (xs[i + 1] & xs[i + 2]) | (xs[i] & xs[i + 2]);
+    }
+    auto f = parity & ~majority;
+
+    for (size_t bits = 0; bits < (1 << 12); bits += 7) {
+        vector<bool> assign(12);
+        bool p = false, m = false;
+        for (size_t i = 0; i < 12; i++) {
+            assign[i] = bits & (1 << i);
+            p ^= assign[i];
+        }
+        for (size_t i = 0; i < 12; i += 3) {
+            m |= (assign[i] + assign[i + 1] + assign[i + 2]) >= 2;
+        }
+        BOOST_REQUIRE_EQUAL(f.execute(assign), p && !m);
+    }
+
+    // 逐次に計算しても同じノードになる
+    table.set_threads(1);
+    auto g = parallel_boolean_function::zero();
+    for (size_t i = 12; i-- > 0;) g = xs[i] ^ g;
+    BOOST_REQUIRE(g == parity);
+}
+
+BOOST_AUTO_TEST_CASE(test_concurrent_callers) {
+    // 複数のスレッドが同じテーブルで同時に演算を行っても、同じ関数は同じノードになる
+    auto& table = parallel_boolean_function::table();
+    table.set_threads(2);
+    vector<size_t> results(4);
+    vector<thread> threads;
+    for (size_t t = 0; t < results.size(); t++) {
+        threads.emplace_back([t, &results] {
+            auto f = parallel_boolean_function::zero();
+            for (size_t k = 0; k < 16; k++) {
+                const size_t i = 100 + (k * (2 * t + 1) * 5) % 16;
+                f |= parallel_boolean_function(i) & parallel_boolean_function(i ^ 1);
+            }
+            results[t] = std::hash<parallel_boolean_function>()(f);
+        });
+    }
+    for (auto& t : threads) t.join();
+    for (size_t t = 1; t < results.size(); t++) BOOST_REQUIRE_EQUAL(results[t], results[0]);
+    table.set_threads(1);
+}
+
+BOOST_AUTO_TEST_CASE(test_combination) {
+    auto& table = parallel_combination::table();
+    table.set_threads(4);
+    parallel_combination p = parallel_combination::zero(), q = parallel_combination::zero();
+    arena_combination a = arena_combination::zero(), b = arena_combination::zero();
+    for (size_t i = 0; i < 10; i++) {
+        p += parallel_combination(i) * parallel_combination((i * 3) % 10);
+        q += parallel_combination(i) + parallel_combination((i * 7) % 10 + 10);
+        a += arena_combination(i) * arena_combination((i * 3) % 10);
+        b += arena_combination(i) + arena_combination((i * 7) % 10 + 10);
+    }
+    count_visitor<parallel_combination, size_t> pc;
+    count_visitor<arena_combination, size_t> ac;
+    BOOST_REQUIRE_EQUAL((p * q).accept(pc), (a * b).accept(ac));
+    BOOST_REQUIRE_EQUAL(p.meet(q).accept(pc), a.meet(b).accept(ac));
+    BOOST_REQUIRE_EQUAL((p + q).accept(pc), (a + b).accept(ac));
+    BOOST_REQUIRE_EQUAL((p & q).accept(pc), (a & b).accept(ac));
+    table.set_threads(1);
+}
+
+BOOST_AUTO_TEST_CASE(test_count) {
+    arena_combination_manager m;
+    auto s = m.zero();
+    for (size_t i = 0; i < 40; i++) s += m.var(i);
+    auto p = s * s;
+    BOOST_REQUIRE_EQUAL(p.count(), 820u);
+    BOOST_REQUIRE_EQUAL(p.count<double>(), 820.0);
+    BOOST_REQUIRE_EQUAL(p.count<big_uint>().to_string(), "820");
+    // 全ての部分集合の数は 2^40
+    auto all = m.one();
+    for (size_t i = 0; i < 40; i++) all = all * (m.one() + m.var(i));
+    BOOST_REQUIRE_EQUAL(all.count(), uint64_t(1) << 40);
+    BOOST_REQUIRE_EQUAL((all * all).count<big_uint>(), big_uint(uint64_t(1) << 40));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(boloq_manager_test)
+
+BOOST_AUTO_TEST_CASE(test_independent_tables) {
+    const size_t default_size = arena_boolean_function::table().size();
+    arena_boolean_function_manager m1, m2;
+    auto x1 = m1.var(0), y1 = m1.var(1);
+    auto x2 = m2.var(0), y2 = m2.var(1), z2 = m2.var(2);
+    auto f1 = x1 ^ y1;
+    auto f2 = (x2 ^ y2) | z2;
+    BOOST_REQUIRE(&f1.manager() == &m1.table());
+    BOOST_REQUIRE(&f2.manager() == &m2.table());
+    BOOST_REQUIRE(f1.is_exclusive_disjunction());
+    BOOST_REQUIRE(!f2.is_exclusive_disjunction());
+    BOOST_REQUIRE((f1 & ~f1) == m1.zero());
+    BOOST_REQUIRE(f1 != (m2.var(0) ^ m2.var(1)));
+    BOOST_REQUIRE(m1.table().size() < m2.table().size());
+    BOOST_REQUIRE_EQUAL(arena_boolean_function::table().size(), default_size);
+
+    // 異なるマネージャの論理関数どうしは演算できない
+    BOOST_CHECK_THROW(x1 & x2, std::invalid_argument);
+    BOOST_CHECK_THROW(f1.ite(f2, m1.one()), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(test_destroy_manager) {
+    for (size_t n = 0; n < 3; n++) {
+        boolean_function_manager m;
+        auto f = m.zero();
+        for (size_t i = 0; i < 32; i++) f = f ^ m.var(i);
+        unordered_map<size_t, bool> assign;
+        for (size_t i = 0; i < 32; i++) assign[i] = (i % 3 == 0);
+        BOOST_REQUIRE(f.execute(assign));
+    }
+
+    arena_combination_manager m;
+    auto s = m.zero();
+    for (size_t i = 0; i < 8; i++) s += m.var(i);
+    count_visitor<arena_combination, size_t> c;
+    BOOST_REQUIRE_EQUAL((s * s).accept(c), 36u);
+    BOOST_CHECK_THROW(s + arena_combination(0), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(boloq_reorder_test)
+
+/*!
+ * (a_0 & b_0) | ... | (a_{n-1} & b_{n-1}) を a が全て先に来る順序で作ります
+ */
+template<class M>
+typename M::value_type make_pairs(M& m, const size_t n) {
+    auto f = m.zero();
+    for (size_t i = 0; i < n; i++) f |= m.var(i) & m.var(n + i);
+    return f;
+}
+
+template<class M>
+void check_sifting() {
+    const size_t n = 8;
+    M m;
+    auto f = make_pairs(m, n);
+    vector<unordered_map<size_t, bool>> assigns;
+    vector<bool> expected;
+    for (size_t k = 0; k < 256; k++) {
+        unordered_map<size_t, bool> assign;
+        for (size_t i = 0; i < 2 * n; i++) assign[i] = ((k * 2654435761u) >> (i + 3)) & 1;
+        assigns.push_back(assign);
+        expected.push_back(f.execute(assign));
+    }
+
+    const auto s = m.table().reorder();
+    BOOST_REQUIRE(s.swaps > 0);
+    BOOST_REQUIRE_LT(s.nodes_after, s.nodes_before);
+    BOOST_REQUIRE_LE(m.table().size(), 2 * n);
+    for (size_t k = 0; k < assigns.size(); k++) {
+        BOOST_REQUIRE_EQUAL(f.execute(assigns[k]), expected[k]);
+    }
+    // 新しい順序で作り直しても同じノードになる
+    BOOST_REQUIRE(make_pairs(m, n) == f);
+    m.table().gc();
+    BOOST_REQUIRE_LE(m.table().size(), 2 * n);
+}
+
+BOOST_AUTO_TEST_CASE(test_sifting) {
+    check_sifting<arena_boolean_function_manager>();
+    check_sifting<complement_boolean_function_manager>();
+}
+
+BOOST_AUTO_TEST_CASE(test_group_sifting) {
+    const size_t n = 6;
+    arena_boolean_function_manager m;
+    // a_0..a_3 をビットベクタとしてまとめる
+    m.table().group_variables({0, 1, 2, 3});
+    auto f = make_pairs(m, n);
+    m.table().reorder();
+    auto& t = m.table();
+    for (size_t i = 1; i < 4; i++) BOOST_REQUIRE_EQUAL(t.level(i), t.level(0) + i);
+    BOOST_REQUIRE(make_pairs(m, n) == f);
+    BOOST_CHECK_THROW(t.group_variables({3, 4}), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(test_sparse_sifting) {
+    // 間の空いたラベルでも、入れ替えるのは現れた変数だけ
+    const size_t n = 4;
+    const uint32_t stride = 1u << 24;
+    arena_boolean_function_manager m;
+    auto f = m.zero();
+    for (uint32_t i = 0; i < n; i++) f |= m.var(i * stride) & m.var((n + i) * stride);
+    auto& t = m.table();
+    t.group_variables({0, stride});
+    const auto s = t.reorder();
+    BOOST_REQUIRE_LT(s.nodes_after, s.nodes_before);
+    BOOST_REQUIRE_LT(s.swaps, 64 * n * n);
+    BOOST_REQUIRE_EQUAL(t.level(stride), t.level(0) + stride);
+    auto g = m.zero();
+    for (uint32_t i = 0; i < n; i++) g |= m.var(i * stride) & m.var((n + i) * stride);
+    BOOST_REQUIRE(f == g);
+}
+
+BOOST_AUTO_TEST_CASE(test_auto_reorder) {
+    const size_t n = 10;
+    arena_boolean_function_manager m;
+    m.table().set_auto_reorder(true, 64);
+    auto f = make_pairs(m, n);
+    // 自動的に順序を変更しなければ 2^(n+1) 程度のノードになる
+    BOOST_REQUIRE_LT(m.table().size(), size_t(1) << (n / 2));
+    BOOST_REQUIRE(m.table().level(n) != n);
+    m.table().set_auto_reorder(false);
+    BOOST_REQUIRE(make_pairs(m, n) == f);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(boloq_ordering_test)
+
+/*!
+ * 辺 {i, n + i} からなる問題で、与えたラベルを用いて (a_0 & b_0) | ... を作ったときのノードの数を返します
+ */
+size_t pairs_size(const vector<size_t>& labels, const size_t n) {
+    arena_boolean_function_manager m;
+    auto f = m.zero();
+    for (size_t i = 0; i < n; i++) f |= m.var(labels[i]) & m.var(labels[n + i]);
+    m.table().gc();
+    return m.table().size();
+}
+
+BOOST_AUTO_TEST_CASE(test_hypergraph_orders) {
+    const size_t n = 8;
+    vector<vector<size_t>> edges;
+    for (size_t i = 0; i < n; i++) edges.push_back({i, n + i});
+    vector<size_t> identity(2 * n);
+    for (size_t v = 0; v < 2 * n; v++) identity[v] = v;
+
+    for (const auto& labels : {force_order(edges, 2 * n), min_span_order(edges, 2 * n)}) {
+        // ラベルは置換になっている
+        vector<size_t> sorted(labels);
+        sort(sorted.begin(), sorted.end());
+        BOOST_REQUIRE(sorted == identity);
+        BOOST_REQUIRE_EQUAL(total_span(edges, labels), n);
+        BOOST_REQUIRE_LE(pairs_size(labels, n), 2 * n);
+    }
+    BOOST_REQUIRE_GT(pairs_size(identity, n), 1u << n);
+}
+
+BOOST_AUTO_TEST_CASE(test_dfs_order) {
+    // 外部入力 0..2n-1、ゲート g_i = a_i & b_i、出力は g_i の or の連鎖
+    const size_t n = 6;
+    vector<netlist_gate> gates;
+    for (size_t i = 0; i < n; i++) gates.push_back({2 * n + i, {i, n + i}});
+    size_t last = 2 * n;
+    for (size_t i = 1; i < n; i++) {
+        gates.push_back({3 * n + i, {last, 2 * n + i}});
+        last = 3 * n + i;
+    }
+    const auto labels = dfs_order(gates, {last}, 2 * n);
+    for (size_t i = 0; i < n; i++) {
+        BOOST_REQUIRE_EQUAL(max(labels[i], labels[n + i]) - min(labels[i], labels[n + i]), 1u);
+    }
+    BOOST_REQUIRE_LE(pairs_size(labels, n), 2 * n);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(boloq_serialize_test)
+
+template<class M>
+void check_round_trip() {
+    M m;
+    auto f = (m.var(0) & m.var(1)) | (m.var(2) ^ m.var(3));
+    auto g = ~f & m.var(4);
+    stringstream ss;
+    save_diagrams(ss, vector<decltype(f)>{f, g, m.one(), m.zero()});
+
+    // 別のテーブルに読み込んでも同じ関数を表す
+    M n;
+    auto loaded = load_diagrams<decltype(f)>(ss, n.table());
+    BOOST_REQUIRE_EQUAL(loaded.size(), 4u);
+    BOOST_REQUIRE(loaded[2] == n.one());
+    BOOST_REQUIRE(loaded[3] == n.zero());
+    for (auto& assign : assign_generator({{0, 1, 2, 3, 4}})) {
+        BOOST_REQUIRE_EQUAL(loaded[0].execute(assign), f.execute(assign));
+        BOOST_REQUIRE_EQUAL(loaded[1].execute(assign), g.execute(assign));
+    }
+    // 同じテーブルに読み込むと同じノードになる
+    stringstream again;
+    save_diagram(again, g);
+    BOOST_REQUIRE(load_diagram<decltype(g)>(again, m.table()) == g);
+}
+
+BOOST_AUTO_TEST_CASE(test_boolean_function) {
+    check_round_trip<boolean_function_manager>();
+    check_round_trip<arena_boolean_function_manager>();
+    check_round_trip<complement_boolean_function_manager>();
+}
+
+BOOST_AUTO_TEST_CASE(test_combination) {
+    arena_combination_manager m;
+    auto s = m.var(0) * m.var(1) + m.var(2) + m.one();
+    stringstream ss;
+    save_diagram(ss, s);
+    arena_combination_manager n;
+    auto t = load_diagram<arena_combination>(ss, n.table());
+    BOOST_REQUIRE_EQUAL(t.count(), 3u);
+    BOOST_REQUIRE(t == n.var(0) * n.var(1) + n.var(2) + n.one());
+}
+
+BOOST_AUTO_TEST_CASE(test_corrupted) {
+    boolean_function_manager m;
+    stringstream ss;
+    save_diagram(ss, m.var(0) & ~m.var(1));
+    const string data = ss.str();
+
+    // 種類が異なる
+    stringstream kind(data);
+    BOOST_REQUIRE_THROW(load_diagram<combination>(kind), runtime_error);
+    // 途中で切れている
+    stringstream truncated(data.substr(0, data.size() - 3));
+    BOOST_REQUIRE_THROW(load_diagram<boolean_function>(truncated, m.table()), runtime_error);
+    // 内容が書き換えられている
+    string flipped = data;
+    flipped[flipped.size() - 9] ^= 1;
+    stringstream corrupt(flipped);
+    BOOST_REQUIRE_THROW(load_diagram<boolean_function>(corrupt, m.table()), runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(test_export) {
+    // 木として表示すると 2^40 行になるが、DAG では先頭以外の変数ごとに 2 ノードになる
+    boolean_function_manager m;
+    auto f = m.zero();
+    for (size_t i = 0; i < 40; i++) f ^= m.var(i);
+    auto g = f & m.var(0);
+
+    stringstream edges;
+    write_edge_list(edges, vector<boolean_function>{f, g});
+    string line;
+    getline(edges, line);
+    BOOST_REQUIRE_EQUAL(line, "p 80 2");
+    size_t nodes = 0, roots = 0;
+    while (getline(edges, line)) {
+        nodes += (line[0] == 'n');
+        roots += (line[0] == 'r');
+    }
+    BOOST_REQUIRE_EQUAL(nodes, 80u);
+    BOOST_REQUIRE_EQUAL(roots, 2u);
+
+    stringstream dot;
+    write_dot(dot, f);
+    const string d = dot.str();
+    size_t ranks = 0;
+    for (size_t p = d.find("rank=same"); p != string::npos; p = d.find("rank=same", p + 1)) ranks++;
+    BOOST_REQUIRE_EQUAL(ranks, 40u);
+    BOOST_REQUIRE(d.find("style=dashed") != string::npos);
+
+    stringstream json;
+    write_json(json, m.one());
+    BOOST_REQUIRE_EQUAL(json.str(), "{\"roots\":[1],\"nodes\":[]}\n");
+}
+
+BOOST_AUTO_TEST_CASE(test_mapped_boolean_function) {
+    complement_boolean_function_manager m;
+    auto f = (m.var(0) & m.var(1)) | (m.var(2) ^ m.var(3));
+    const string path = "boloq_mapped_test.bin";
+    {
+        ofstream os(path, ios::binary);
+        save_mapped(os, f);
+    }
+    {
+        mapped_file file(path);
+        mapped_boolean_function g(file.data(), file.size());
+        for (size_t i = 0; i < 16; i++) {
+            bool inputs[4];
+            unordered_map<size_t, bool> assign;
+            for (size_t l = 0; l < 4; l++) assign[l] = inputs[l] = (i >> l) & 1;
+            BOOST_REQUIRE_EQUAL(g.evaluate(inputs), f.execute(assign));
+        }
+        BOOST_REQUIRE_EQUAL(g.satcount(4), f.satcount(4));
+        BOOST_REQUIRE_EQUAL(distance(g.begin(), g.end()), distance(f.begin(), f.end()));
+        BOOST_REQUIRE_THROW(mapped_combination(file.data(), file.size()), invalid_argument);
+        BOOST_REQUIRE_THROW(mapped_boolean_function(file.data(), file.size() - 1), invalid_argument);
+    }
+    remove(path.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(test_mapped_combination) {
+    arena_combination_manager m;
+    auto s = m.var(0) * m.var(1) + m.var(2) + m.one();
+    stringstream ss;
+    save_mapped(ss, s);
+    // mmap と同じく境界に揃えた領域に写す
+    const string data = ss.str();
+    vector<uint64_t> buffer((data.size() + 7) / 8);
+    memcpy(buffer.data(), data.data(), data.size());
+    mapped_combination t(buffer.data(), data.size());
+
+    BOOST_REQUIRE_EQUAL(t.count(), 3u);
+    BOOST_REQUIRE(t.contains(vector<uint32_t>{1, 0}));
+    BOOST_REQUIRE(t.contains(vector<uint32_t>{2}));
+    BOOST_REQUIRE(t.contains(vector<uint32_t>{}));
+    BOOST_REQUIRE(!t.contains(vector<uint32_t>{0}));
+    BOOST_REQUIRE(!t.contains(vector<uint32_t>{0, 1, 2}));
+    set<vector<uint32_t>> sets(t.begin(), t.end());
+    BOOST_REQUIRE(sets == (set<vector<uint32_t>>{{}, {0, 1}, {2}}));
+}
+
+BOOST_AUTO_TEST_CASE(test_mapped_corrupted) {
+    arena_combination_manager m;
+    auto s = m.var(0) * m.var(1) + m.var(2) + m.one();
+    stringstream ss;
+    save_mapped(ss, s);
+    const string data = ss.str();
+    vector<uint64_t> buffer((data.size() + 7) / 8);
+    memcpy(buffer.data(), data.data(), data.size());
+    mapped_combination(buffer.data(), data.size()).validate();
+
+    // ヘッダの破損は生成時に検出する
+    auto* h = reinterpret_cast<mapped_header*>(buffer.data());
+    h->root ^= 1;
+    BOOST_REQUIRE_THROW(mapped_combination(buffer.data(), data.size()), invalid_argument);
+    h->root ^= 1;
+
+    // 根の子を自身に向けると、生成はできるが辿る時に検出する
+    auto* records = reinterpret_cast<mapped_record*>(h + 1);
+    records[h->root].next[0] = static_cast<uint32_t>(h->root);
+    mapped_combination t(buffer.data(), data.size());
+    BOOST_REQUIRE_THROW(t.validate(), invalid_argument);
+    BOOST_REQUIRE_THROW(t.count(), invalid_argument);
+    BOOST_REQUIRE_THROW(t.contains(vector<uint32_t>{}), invalid_argument);
+    BOOST_REQUIRE_THROW(set<vector<uint32_t>>(t.begin(), t.end()), invalid_argument);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(boloq_dimacs_test)
+
+BOOST_AUTO_TEST_CASE(test_read_dimacs) {
+    stringstream ss("c example\np cnf 4 3\n1 -2 0\n2 3\n -4 0 c trailing\n4 0\n%\n0\n");
+    const auto cnf = read_dimacs(ss);
+    BOOST_REQUIRE_EQUAL(cnf.variables, 4u);
+    BOOST_REQUIRE_EQUAL(cnf.clauses.size(), 3u);
+    BOOST_REQUIRE(cnf.clauses[1] == (vector<int>{2, 3, -4}));
+
+    stringstream bad("p cnf 2 1\n1 3 0\n");
+    BOOST_REQUIRE_THROW(read_dimacs(bad), runtime_error);
+    stringstream garbage("p cnf 2 1\n1 x 0\n");
+    BOOST_REQUIRE_THROW(read_dimacs(garbage), runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(test_conjoin_schedules) {
+    // 隣り合う変数が等しいことを表す鎖
+    cnf_formula cnf;
+    cnf.variables = 12;
+    for (int v = 1; v < 12; v++) {
+        cnf.clauses.push_back({v, -(v + 1)});
+        cnf.clauses.push_back({-v, v + 1});
+    }
+    cnf.clauses.push_back({1, 12});
+
+    arena_boolean_function_manager m;
+    cnf_builder<arena_boolean_function> naive(m.table(), conjoin_schedule::linear);
+    const auto expected = naive.build(cnf);
+    BOOST_REQUIRE_EQUAL(expected.satcount(12), 1u);
+    for (const auto s : {conjoin_schedule::balanced, conjoin_schedule::bucket, conjoin_schedule::smallest_first}) {
+        cnf_builder<arena_boolean_function> b(m.table(), s);
+        BOOST_REQUIRE(b.build(cnf) == expected);
+        BOOST_REQUIRE(b.statistics().conjunctions > 0);
+        BOOST_REQUIRE(b.statistics().peak_nodes > 0);
+    }
+
+    // 途中の変数を量化しても、最後に量化したものと等しい
+    vector<size_t> inner;
+    for (size_t v = 2; v < 12; v++) inner.push_back(v);
+    vector<arena_boolean_function::label_type> labels;
+    for (const size_t v : inner) labels.push_back(v - 1);
+    for (const auto s : {conjoin_schedule::linear, conjoin_schedule::bucket, conjoin_schedule::smallest_first}) {
+        cnf_builder<arena_boolean_function> b(m.table(), s);
+        b.set_quantified(inner);
+        BOOST_REQUIRE(b.build(cnf) == expected.exists(labels));
+    }
+
+    // 変数の順序を求めてから変換できる
+    cnf_builder<arena_boolean_function> ordered(m.table());
+    ordered.set_labels(min_span_order(cnf_edges(cnf), cnf.variables));
+    BOOST_REQUIRE_EQUAL(ordered.build(cnf).satcount(12), 1u);
+
+    // 量化する変数はラベルを設定する前に指定しても、設定したラベルで量化する
+    vector<size_t> reversed;
+    for (size_t v = 0; v < 12; v++) reversed.push_back(11 - v);
+    cnf_builder<arena_boolean_function> relabeled(m.table());
+    relabeled.set_quantified({2, 3, 4});
+    relabeled.set_labels(reversed);
+    cnf_builder<arena_boolean_function> plain(m.table());
+    plain.set_labels(reversed);
+    const vector<arena_boolean_function::label_type> mapped = {10, 9, 8};
+    BOOST_REQUIRE(relabeled.build(cnf) == plain.build(cnf).exists(mapped));
+    BOOST_REQUIRE_THROW(relabeled.set_quantified({0}), invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(test_streaming_dimacs) {
+    const string text = "c chain\np cnf 5 9\n1 -2 0 -1 2 0\n2 -3 0 -2 3 0\n3 -4 0 -3\n4 0 4 -5 0\n-4 5 0\n1 5\n";
+    stringstream whole(text);
+    const auto cnf = read_dimacs(whole);
+
+    arena_boolean_function_manager m;
+    for (const auto s : {conjoin_schedule::linear, conjoin_schedule::balanced,
+                         conjoin_schedule::bucket, conjoin_schedule::smallest_first}) {
+        cnf_builder<arena_boolean_function> b(m.table(), s);
+        const auto expected = b.build(cnf);
+        const size_t conjunctions = b.statistics().conjunctions;
+        stringstream ss(text);
+        dimacs_reader reader(ss);
+        BOOST_REQUIRE_EQUAL(reader.variables(), 5u);
+        BOOST_REQUIRE_EQUAL(reader.declared_clauses(), 9u);
+        BOOST_REQUIRE(b.build(reader) == expected);
+        BOOST_REQUIRE_EQUAL(b.statistics().conjunctions, conjunctions);
+        BOOST_REQUIRE(reader.next() == nullptr);
+    }
+    BOOST_REQUIRE_EQUAL(cnf_builder<arena_boolean_function>(m.table()).build(cnf).satcount(5), 1u);
+
+    stringstream bad("p cnf 2 1\n1 3 0\n");
+    dimacs_reader reader(bad);
+    cnf_builder<arena_boolean_function> b(m.table(), conjoin_schedule::linear);
+    BOOST_REQUIRE_THROW(b.build(reader), runtime_error);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(boloq_netlist_test)
+
+// 全加算器の和と桁上げ
+bool full_adder(const unordered_map<size_t, bool>& a, const size_t output) {
+    const int n = a.at(0) + a.at(1) + a.at(2);
+    return output == 0 ? (n % 2) : (n >= 2);
+}
+
+void check_full_adder(const logic_netlist& n) {
+    BOOST_REQUIRE_EQUAL(n.inputs, 3u);
+    arena_boolean_function_manager m;
+    netlist_builder<arena_boolean_function> b(m.table());
+    const auto labels = dfs_order(n.structure(), n.outputs, n.inputs);
+    b.set_labels(labels);
+    auto fs = b.build(n);
+    BOOST_REQUIRE_EQUAL(fs.size(), 2u);
+    for (auto& assign : assign_generator({{0, 1, 2}})) {
+        unordered_map<size_t, bool> relabeled;
+        for (size_t i = 0; i < 3; i++) relabeled[labels[i]] = assign[i];
+        BOOST_REQUIRE_EQUAL(fs[0].execute(relabeled), full_adder(assign, 0));
+        BOOST_REQUIRE_EQUAL(fs[1].execute(relabeled), full_adder(assign, 1));
+    }
+    BOOST_REQUIRE(b.statistics().peak_live > 0);
+}
+
+BOOST_AUTO_TEST_CASE(test_blif) {
+    stringstream ss(
+        "# full adder\n"
+        ".model fa\n"
+        ".inputs a b \\\n cin\n"
+        ".outputs s cout\n"
+        ".names a b t\n"
+        "10 1\n"
+        "01 1\n"
+        ".names t cin s\n"
+        "00 0\n"
+        "11 0\n"
+        ".names a b cin cout\n"
+        "11- 1\n"
+        "1-1 1\n"
+        "-11 1\n"
+        ".end\n");
+    check_full_adder(read_blif(ss));
+
+    stringstream undriven(".inputs a\n.outputs y\n.names a z y\n11 1\n");
+    BOOST_REQUIRE_THROW(read_blif(undriven), runtime_error);
+    stringstream latch(".inputs a\n.outputs y\n.latch a y 0\n");
+    BOOST_REQUIRE_THROW(read_blif(latch), runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(test_aiger) {
+    // XOR を AND と否定で組み立てる。桁上げは否定した出力として取り出す
+    const string ascii =
+        "aag 12 3 0 2 9\n2\n4\n6\n18\n25\n"
+        "8 2 4\n10 3 5\n12 9 11\n"       // 12 = a xor b
+        "14 12 6\n16 13 7\n18 15 17\n"   // 18 = a xor b xor c
+        "20 2 4\n22 12 6\n24 21 23\n"    // 24 = carry の否定
+        "c\ncomment\n";
+    stringstream ss(ascii);
+    logic_netlist n = read_aiger(ss);
+    BOOST_REQUIRE_EQUAL(n.outputs.size(), 2u);
+    arena_boolean_function_manager m;
+    netlist_builder<arena_boolean_function> b(m.table());
+    auto fs = b.build(n);
+    for (auto& assign : assign_generator({{0, 1, 2}})) {
+        BOOST_REQUIRE_EQUAL(fs[0].execute(assign), full_adder(assign, 0));
+        BOOST_REQUIRE_EQUAL(fs[1].execute(assign), full_adder(assign, 1));
+    }
+
+    // 同じ回路の二進形式
+    string binary = "aig 12 3 0 2 9\n18\n25\n";
+    const size_t ands[9][3] = {{8, 2, 4}, {10, 3, 5}, {12, 9, 11}, {14, 12, 6}, {16, 13, 7},
+                               {18, 15, 17}, {20, 2, 4}, {22, 12, 6}, {24, 21, 23}};
+    for (const auto& g : ands) {
+        // 二進形式では入力の大きい方を先に書く
+        const size_t r0 = max(g[1], g[2]), r1 = min(g[1], g[2]);
+        binary += char(g[0] - r0);
+        binary += char(r0 - r1);
+    }
+    stringstream bs(binary);
+    auto gs = b.build(read_aiger(bs));
+    BOOST_REQUIRE(gs[0] == fs[0]);
+    BOOST_REQUIRE(gs[1] == fs[1]);
+
+    stringstream latch("aag 1 0 1 0 0\n2 3\n");
+    BOOST_REQUIRE_THROW(read_aiger(latch), runtime_error);
+}
+
+BOOST_AUTO_TEST_SUITE_END()